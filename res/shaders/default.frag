@@ -7,7 +7,10 @@ layout (location = 3) in float radius;
 
 layout (location = 0) out vec4 outFragColor;
 
-layout(set = 0, binding = 1) uniform sampler2D textures[25];
+//set by the renderer from the device limits
+layout(constant_id = 0) const int TEXTURE_SLOTS = 25;
+
+layout(set = 0, binding = 0) uniform sampler2D textures[TEXTURE_SLOTS];
 
 void main()
 {
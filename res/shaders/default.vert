@@ -11,7 +11,7 @@ layout (location = 1) out vec2 outTexCoord;
 layout (location = 2) out int outTexID;
 layout (location = 3) out float outRadius;
 
-layout (set = 0, binding = 0) uniform CameraBuffer {
+layout (push_constant) uniform CameraConstants {
 	mat4 viewProj;
 } cameraData;
 
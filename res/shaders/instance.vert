@@ -1,42 +1,34 @@
 #version 450
 
-#include "res/shaders/random.glsl"
-
-layout (location = 0) in vec3 vPosition;
-//layout (location = 1) in vec4 vColor;
-//layout (location = 2) in vec2 vTexCoord;
-
 layout (location = 0) out vec4 outColor;
 
-layout (set = 0, binding = 0) uniform CameraBuffer {
-	mat4 viewProj;
-} cameraData;
-
-vec2 random_vec2(float c) {
-	float x = random(c) * 2 - 1;
-	float y = random(random(x)) * 2 - 1;
-	return vec2(x, y);
-}
+//written by particles.comp
+layout(std430, set = 0, binding = 0) readonly buffer Positions { vec2 positions[]; };
+layout(std430, set = 0, binding = 2) readonly buffer Lifetimes { float lifetimes[]; };
+layout(std430, set = 0, binding = 3) readonly buffer AliveLists { uint alive[]; };
 
-#define SIZE 100
+layout (push_constant) uniform Constants {
+	mat4 viewProj;
+	vec4 color;
+	float size;
+	float lifetime;
+	uint current;
+	uint maxParticles;
+} pc;
+
+const vec2 corners[6] = vec2[](
+	vec2(-1, -1), vec2(1, -1), vec2(1, 1),
+	vec2(-1, -1), vec2(1, 1), vec2(-1, 1)
+);
 
 void main()
 {
-	vec3 dp = vec3(random_vec2(gl_InstanceIndex), 0) * SIZE;
-	dp.z = -random(dp.x) * 20;
+	//one quad per instance, no vertex buffer
+	uint idx = alive[pc.current * pc.maxParticles + gl_InstanceIndex];
 
-	vec3 pos = vPosition + dp;
-	//pos -= vec3(0, 0, random(gl_InstanceIndex) * 2);
+	vec2 pos = positions[idx] + corners[gl_VertexIndex] * pc.size;
+	gl_Position = pc.viewProj * vec4(pos, 0.0f, 1.0f);
 
-	mat4 transformMatrix = cameraData.viewProj;
-	gl_Position = transformMatrix * vec4(pos, 1.0f);
-
-
-	float cr = random(gl_InstanceIndex);
-	float cg = random(cr);
-	float cb = random(cg);
-
-	outColor = vec4(cr, cg, cb, 1.0);
+	float fade = clamp(lifetimes[idx] / pc.lifetime, 0.0, 1.0);
+	outColor = vec4(pc.color.rgb, pc.color.a * fade);
 }
-
-
@@ -1,5 +1,6 @@
 #include "application.h"
 #include "renderer.h"
+#include "render_api.h"
 
 #include "vk_engine.h"
 #include "window.h"
@@ -13,6 +14,9 @@ namespace Atlas {
 
 	Application *Application::s_Instance = nullptr;
 
+	//seconds the viewport size has to stay the same before its targets are shrunk
+	static const float c_ViewportSettleTime = 0.5f;
+
 	Application::Application()
 	{
 		CORE_ASSERT(!s_Instance, "Application already created!");
@@ -20,6 +24,8 @@ namespace Atlas {
 
 		m_ViewportSize = { 1600, 900 };
 
+		m_ThreadPool = make_scope<ThreadPool>();
+
 		WindowInfo info = { "Vulkan Engine", 1600, 900 };
 		m_Window = make_scope<Window>(info);
 		m_Window->set_event_callback(BIND_EVENT_FN(Application::on_event));
@@ -29,8 +35,7 @@ namespace Atlas {
 		m_ImGuiLayer = make_ref<ImGuiLayer>();
 		m_ImGuiLayer->on_attach();
 
-		m_ColorTexture = make_ref<Texture>((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y, TextureFormat::R8G8B8A8);
-		m_DepthTexture = make_ref<Texture>((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y, TextureFormat::D32);
+		resize_viewport_targets((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
 
 		Render2D::init();
 	}
@@ -39,8 +44,15 @@ namespace Atlas {
 	{
 		m_Engine->wait_idle();
 
+		//finish pending background work before anything it uses gets destroyed
+		m_ThreadPool.reset();
+
 		Render2D::cleanup();
 
+		m_ColorTexture = nullptr;
+		m_DepthTexture = nullptr;
+		m_RenderTargetPool.clear();
+
 		for (uint32_t i = 0; i < m_LayerStack.size(); i++) {
 			Ref<Layer> layer = m_LayerStack.back();
 			layer->on_detach();
@@ -113,12 +125,16 @@ namespace Atlas {
 					ImPlot::EndPlot();
 
 					ImGui::Text("average: %.3f ms/frame (%.1f FPS)", frameTime * 1000, 1 / frameTime);
+
+					render_gpu_timings();
+					render_frame_statistics();
 				}
 				ImGui::End();
 
 				render_viewport();
 
 				m_Engine->exec_swapchain_renderpass(swapchainImageIndex, { 0, 0, 0, 0 }, [&]() {
+					GPU_SCOPE("ImGui");
 					m_ImGuiLayer->on_imgui();
 				});
 
@@ -130,6 +146,9 @@ namespace Atlas {
 
 			for (Event e : m_QueuedEvents) on_event(e);
 			m_QueuedEvents.clear();
+
+			update_viewport_targets();
+			m_RenderTargetPool.update();
 		}
 	}
 
@@ -149,7 +168,10 @@ namespace Atlas {
 		viewportBounds[1] = { viewportMaxRegion.x + viewportOffset.x, viewportMaxRegion.y + viewportOffset.y };
 		auto viewportSize = viewportBounds[1] - viewportBounds[0];
 
-		ImGui::Image(m_ColorTexture->get_id(), { viewportSize.x, viewportSize.y });
+		//the targets can be larger than the viewport while it is resized
+		glm::uvec2 extent = m_ColorTexture->get_render_extent();
+		ImVec2 uv1 = { (float)extent.x / m_ColorTexture->width(), (float)extent.y / m_ColorTexture->height() };
+		ImGui::Image(m_ColorTexture->get_id(), { viewportSize.x, viewportSize.y }, { 0, 0 }, uv1);
 		ImGui::End();
 
 		ImGui::ShowDemoWindow();
@@ -161,6 +183,90 @@ namespace Atlas {
 		}
 	}
 
+	void Application::render_gpu_timings()
+	{
+		vkutil::GpuProfiler &profiler = m_Engine->gpu_profiler();
+
+		if (!profiler.is_supported()) {
+			ImGui::TextDisabled("gpu timestamps are not supported");
+			return;
+		}
+
+		//the gpu time close to the cpu frame time means the frame is gpu bound
+		ImGui::Text("gpu: %.3f ms/frame", profiler.get_frame_time());
+
+		const std::vector<float> &frames = profiler.get_frame_history();
+		if (frames.empty()) return;
+
+		ImPlot::SetNextAxesToFit();
+		if (ImPlot::BeginPlot("GPU")) {
+			ImPlot::SetupAxes(NULL, NULL, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+			ImPlot::SetupAxis(ImAxis_Y1, "ms");
+
+			std::vector<float> xs(frames.size()), lower(frames.size(), 0.0f), upper(frames.size());
+			for (size_t i = 0; i < xs.size(); i++) xs[i] = (float)i;
+
+			//every pass is stacked on top of the ones before it, the gap to the frame line is untimed work
+			for (auto &scope : profiler.get_history()) {
+				for (size_t i = 0; i < frames.size(); i++) upper[i] = lower[i] + scope.ms[i];
+				ImPlot::PlotShaded(scope.name.c_str(), xs.data(), lower.data(), upper.data(), (int)frames.size());
+				lower = upper;
+			}
+
+			ImPlot::PlotLine("frame", xs.data(), frames.data(), (int)frames.size());
+			ImPlot::EndPlot();
+		}
+
+		for (auto &timing : profiler.get_timings()) {
+			ImGui::Text("%*s%s: %.3f ms", (int)timing.depth * 2, "", timing.name, timing.ms);
+		}
+	}
+
+	void Application::render_frame_statistics()
+	{
+		vkutil::FrameStatistics &statistics = m_Engine->frame_statistics();
+		const vkutil::FrameStatisticsData &last = statistics.get_last();
+
+		using vkutil::FrameCounter;
+		ImGui::Text("draws: %u, dispatches: %u, render passes: %u", last[FrameCounter::DRAWS], last[FrameCounter::DISPATCHES],
+			last[FrameCounter::RENDER_PASSES]);
+		ImGui::Text("binds: %u shaders, %u buffers, %u descriptors", last[FrameCounter::SHADER_BINDS],
+			last[FrameCounter::BUFFER_BINDS], last[FrameCounter::DESCRIPTOR_BINDS]);
+		ImGui::Text("descriptor pushes: %u, barriers: %u", last[FrameCounter::DESCRIPTOR_PUSHES], last[FrameCounter::BARRIERS]);
+
+		if (!statistics.has_pipeline_statistics()) {
+			ImGui::TextDisabled("pipeline statistics are not supported");
+		}
+		else if (const vkutil::FrameStatisticsData *data = statistics.get_last_pipeline()) {
+			const vkutil::PipelineStatistics &p = data->pipeline;
+			ImGui::Text("vertices: %llu, vertex invocations: %llu, primitives: %llu", (unsigned long long)p.inputVertices,
+				(unsigned long long)p.vertexInvocations, (unsigned long long)p.clippingPrimitives);
+			ImGui::Text("fragment invocations: %llu, compute invocations: %llu", (unsigned long long)p.fragmentInvocations,
+				(unsigned long long)p.computeInvocations);
+		}
+
+		const auto &history = statistics.get_history();
+		if (!history.empty()) {
+			ImPlot::SetNextAxesToFit();
+			if (ImPlot::BeginPlot("Calls")) {
+				ImPlot::SetupAxes(NULL, NULL, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+
+				std::vector<float> xs(history.size()), values(history.size());
+				for (size_t i = 0; i < xs.size(); i++) xs[i] = (float)i;
+
+				for (uint32_t c = 0; c < (uint32_t)FrameCounter::COUNT; c++) {
+					for (size_t i = 0; i < history.size(); i++) values[i] = (float)history[i].counters[c];
+					ImPlot::PlotLine(vkutil::counter_name((FrameCounter)c), xs.data(), values.data(), (int)history.size());
+				}
+
+				ImPlot::EndPlot();
+			}
+		}
+
+		if (ImGui::Button("Export statistics") && statistics.save_json("frame_statistics.json"))
+			CORE_INFO("frame statistics written to frame_statistics.json");
+	}
+
 	//vkutil::VulkanManager &Application::get_vulkan_manager()
 	//{
 	//	return get_instance()->m_Engine->get_manager();
@@ -171,6 +277,11 @@ namespace Atlas {
 		return *get_instance()->m_Engine.get();
 	}
 
+	ThreadPool &Application::get_thread_pool()
+	{
+		return *get_instance()->m_ThreadPool.get();
+	}
+
 	Window &Application::get_window()
 	{
 		return *get_instance()->m_Window.get();
@@ -223,6 +334,11 @@ namespace Atlas {
 		return get_instance()->m_DepthTexture;
 	}
 
+	RenderTargetPool &Application::get_render_target_pool()
+	{
+		return get_instance()->m_RenderTargetPool;
+	}
+
 	void Application::on_event(Event &event)
 	{
 		//if (!event.in_category(EventCategoryMouse)) CORE_TRACE("event: {}", event);
@@ -251,10 +367,39 @@ namespace Atlas {
 	bool Application::on_viewport_resized(ViewportResizedEvent &e)
 	{
 		m_ViewportSize = { e.width, e.height };
+		m_ViewportResizeTime = (float)glfwGetTime();
+
+		uint32_t width = std::max(1u, e.width);
+		uint32_t height = std::max(1u, e.height);
 
-		m_ColorTexture = make_ref<Texture>(e.width, e.height, TextureFormat::R8G8B8A8);
-		m_DepthTexture = make_ref<Texture>(e.width, e.height, TextureFormat::D32);
+		//while the viewport is dragged the targets only grow, rendering covers the part the viewport shows
+		if (width <= m_ColorTexture->width() && height <= m_ColorTexture->height()) {
+			m_ColorTexture->set_render_extent(width, height);
+			m_DepthTexture->set_render_extent(width, height);
+			return false;
+		}
 
+		resize_viewport_targets(width, height);
 		return false;
 	}
+
+	void Application::update_viewport_targets()
+	{
+		if ((float)glfwGetTime() - m_ViewportResizeTime < c_ViewportSettleTime) return;
+
+		glm::uvec2 extent = m_ColorTexture->get_render_extent();
+		if (RenderTargetPool::bucket_size(extent.x) == m_ColorTexture->width()
+			&& RenderTargetPool::bucket_size(extent.y) == m_ColorTexture->height()) return;
+
+		resize_viewport_targets(extent.x, extent.y);
+	}
+
+	void Application::resize_viewport_targets(uint32_t width, uint32_t height)
+	{
+		m_RenderTargetPool.release(m_ColorTexture);
+		m_RenderTargetPool.release(m_DepthTexture);
+
+		m_ColorTexture = m_RenderTargetPool.acquire(width, height, TextureFormat::R8G8B8A8);
+		m_DepthTexture = m_RenderTargetPool.acquire(width, height, TextureFormat::D32);
+	}
 }
\ No newline at end of file
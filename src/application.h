@@ -4,6 +4,8 @@
 #include "layer.h"
 #include "imgui_layer.h"
 #include "texture.h"
+#include "render_target_pool.h"
+#include "thread_pool.h"
 
 #include <glm/glm.hpp>
 
@@ -26,6 +28,7 @@ namespace Atlas {
 
 		//static vkutil::VulkanManager &get_vulkan_manager();
 		static vkutil::VulkanEngine &get_engine();
+		static ThreadPool &get_thread_pool();
 		static Window &get_window();
 		static Application *get_instance();
 		static glm::vec2 get_mouse();
@@ -40,6 +43,7 @@ namespace Atlas {
 
 		static Ref<Texture> get_viewport_color_texture();
 		static Ref<Texture> get_viewport_depth_texture();
+		static RenderTargetPool &get_render_target_pool();
 
 	private:
 		void on_event(Event &event);
@@ -47,7 +51,15 @@ namespace Atlas {
 		bool on_viewport_resized(ViewportResizedEvent &e);
 
 		void render_viewport();
-
+		//per pass gpu timings of the GpuProfiler for the Metrics window
+		void render_gpu_timings();
+		//draw / bind / barrier counters and pipeline statistics of the last frames, exportable to json
+		void render_frame_statistics();
+		//shrinks the viewport targets once the viewport stopped resizing
+		void update_viewport_targets();
+		void resize_viewport_targets(uint32_t width, uint32_t height);
+
+		Scope<ThreadPool> m_ThreadPool;
 		Scope<vkutil::VulkanEngine> m_Engine;
 
 		Scope<Window> m_Window;
@@ -60,9 +72,11 @@ namespace Atlas {
 
 		std::vector<Event> m_QueuedEvents;
 
+		RenderTargetPool m_RenderTargetPool;
 		Ref<Texture> m_ColorTexture;
 		Ref<Texture> m_DepthTexture;
 		glm::vec2 m_ViewportSize;
+		float m_ViewportResizeTime{ 0 };
 
 		//float data[100] = { 1, 2, 3, 4, 3, 2, 1 };
 
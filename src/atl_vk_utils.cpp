@@ -56,6 +56,43 @@ namespace Atlas {
 		return VK_FILTER_MAX_ENUM;
 	}
 
+	VkCullModeFlags atlas_to_vk_cull_mode(CullMode mode) {
+		switch (mode) {
+		case CullMode::NONE: return VK_CULL_MODE_NONE;
+		case CullMode::FRONT: return VK_CULL_MODE_FRONT_BIT;
+		case CullMode::BACK: return VK_CULL_MODE_BACK_BIT;
+		default: CORE_ASSERT(false, "never called");
+		}
+
+		return VK_CULL_MODE_NONE;
+	}
+
+	VkCompareOp atlas_to_vk_compare_op(CompareOp op) {
+		switch (op) {
+		case CompareOp::NEVER: return VK_COMPARE_OP_NEVER;
+		case CompareOp::LESS: return VK_COMPARE_OP_LESS;
+		case CompareOp::EQUAL: return VK_COMPARE_OP_EQUAL;
+		case CompareOp::LESS_OR_EQUAL: return VK_COMPARE_OP_LESS_OR_EQUAL;
+		case CompareOp::GREATER: return VK_COMPARE_OP_GREATER;
+		case CompareOp::NOT_EQUAL: return VK_COMPARE_OP_NOT_EQUAL;
+		case CompareOp::GREATER_OR_EQUAL: return VK_COMPARE_OP_GREATER_OR_EQUAL;
+		case CompareOp::ALWAYS: return VK_COMPARE_OP_ALWAYS;
+		default: CORE_ASSERT(false, "never called");
+		}
+
+		return VK_COMPARE_OP_MAX_ENUM;
+	}
+
+	VkPrimitiveTopology atlas_to_vk_topology(Topology topology) {
+		switch (topology) {
+		case Topology::TRIANGLE_LIST: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		case Topology::TRIANGLE_STRIP: return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+		default: CORE_ASSERT(false, "never called");
+		}
+
+		return VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
+	}
+
 	vkutil::TextureCreateInfo color_format_to_texture_info(TextureFormat f, uint32_t w, uint32_t h) {
 		VkFormat format{};
 
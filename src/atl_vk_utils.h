@@ -6,6 +6,7 @@
 #include "buffer.h"
 #include "shader.h"
 #include "texture.h"
+#include "render_api.h"
 
 namespace Atlas {
 
@@ -13,6 +14,9 @@ namespace Atlas {
 	VkShaderStageFlagBits atlas_to_vk_shaderstage(ShaderStage type);
 	vkutil::VertexAttributeType atlas_to_vk_attribute(VertexAttribute &attribute);
 	VkFilter atlas_to_vk_filter(FilterOptions options);
+	VkCullModeFlags atlas_to_vk_cull_mode(CullMode mode);
+	VkCompareOp atlas_to_vk_compare_op(CompareOp op);
+	VkPrimitiveTopology atlas_to_vk_topology(Topology topology);
 	vkutil::TextureCreateInfo color_format_to_texture_info(TextureFormat f, uint32_t w, uint32_t h);
 
 
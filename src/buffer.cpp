@@ -16,6 +16,8 @@ VkBufferUsageFlags atlas_to_vk_buffer_type(Atlas::BufferTypeFlags type) {
 	if (type & BufferType::INDEX_U32) flagBits |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
 	if (type & BufferType::INDEX_U16) flagBits |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
 	if (type & BufferType::UNIFORM) flagBits |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+	if (type & BufferType::STORAGE) flagBits |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	if (type & BufferType::INDIRECT) flagBits |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
 	CORE_ASSERT(type, "undefined BufferType");
 
@@ -35,7 +37,9 @@ namespace vkutil {
 			vkutil::VulkanManager &manager = Application::get_engine().manager();
 
 			vkutil::AllocatedBuffer buffer{};
-			VkBufferUsageFlags bufferUsage = atlas_to_vk_buffer_type(info.type) | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			//transfer src for read_async
+			VkBufferUsageFlags bufferUsage = atlas_to_vk_buffer_type(info.type) | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+				| VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 			VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
 			if (m_HostVisible) memoryFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
@@ -87,20 +91,18 @@ namespace vkutil {
 		{
 			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
 
-			switch (m_Type)
-			{
-			case BufferType::VERTEX:
+			//storage buffers can also be vertex / index buffers, so check the bits instead of the exact type
+			if (m_Type & BufferType::VERTEX) {
 				vkCmdBindVertexBuffers(cmd, 0, 1, &get_native_buffer()->buffer, &offset);
-				break;
-			case BufferType::INDEX_U16:
+			}
+			else if (m_Type & BufferType::INDEX_U16) {
 				vkCmdBindIndexBuffer(cmd, get_native_buffer()->buffer, offset, VK_INDEX_TYPE_UINT16);
-				break;
-			case BufferType::INDEX_U32:
+			}
+			else if (m_Type & BufferType::INDEX_U32) {
 				vkCmdBindIndexBuffer(cmd, get_native_buffer()->buffer, offset, VK_INDEX_TYPE_UINT32);
-				break;
-			default:
+			}
+			else {
 				CORE_WARN("can't bind this type of buffer: {}", m_Type);
-				return;
 			}
 		}
 
@@ -136,6 +138,25 @@ namespace Atlas {
 		m_Buffer->set_data(data, size);
 	}
 
+	std::future<std::vector<uint8_t>> Buffer::read_async(uint32_t offset, uint32_t size) {
+		if (!m_Initialized) {
+			CORE_WARN("Buffer was never created / or deleted");
+			return vkutil::ReadbackRing::empty();
+		}
+
+		if (offset > m_Buffer->size() || size > m_Buffer->size() - offset) {
+			CORE_WARN("Buffer: read of {} bytes at {} is outside of the buffer ({} bytes)", size, offset, m_Buffer->size());
+			return vkutil::ReadbackRing::empty();
+		}
+
+		if (size == 0) size = m_Buffer->size() - offset;
+
+		vkutil::AllocatedBuffer *buffer = m_Buffer->get_native_buffer();
+		if (!buffer) return vkutil::ReadbackRing::empty();
+
+		return Application::get_engine().read_buffer(buffer->buffer, offset, size);
+	}
+
 	void Buffer::bind(uint64_t offset) {
 		if (!m_Initialized) {
 			CORE_WARN("Buffer was never created / or deleted");
@@ -143,6 +164,7 @@ namespace Atlas {
 		}
 
 		m_Buffer->bind(offset);
+		vkutil::count(vkutil::FrameCounter::BUFFER_BINDS);
 	}
 
 	uint32_t Buffer::size()
@@ -207,4 +229,22 @@ namespace Atlas {
 		info.type = BufferType::UNIFORM;
 		return Buffer(info);
 	}
+
+	Buffer Buffer::storage(uint32_t size, bool hostVisible, BufferTypeFlags extraType)
+	{
+		BufferCreateInfo info{};
+		info.bufferSize = size;
+		info.hostVisible = hostVisible;
+		info.type = BufferType::STORAGE | extraType;
+		return Buffer(info);
+	}
+
+	Buffer Buffer::indirect(uint32_t size, bool hostVisible)
+	{
+		BufferCreateInfo info{};
+		info.bufferSize = size;
+		info.hostVisible = hostVisible;
+		info.type = BufferType::INDIRECT | BufferType::STORAGE;
+		return Buffer(info);
+	}
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ namespace Atlas {
 			INDEX_U32 = BIT(2),
 			UNIFORM = BIT(3),
 			STORAGE = BIT(4),
+			INDIRECT = BIT(5),
 		};
 	}
 	using BufferTypeFlags = uint32_t;
@@ -34,6 +35,9 @@ namespace Atlas {
 		Buffer(const Buffer &other) = delete;
 
 		void set_data(void *data, uint32_t size);
+		//copies size bytes from offset (the rest of the buffer if size is 0) to the cpu. the copy is recorded at
+		//this point of the frame, the future resolves once the frame finished on the gpu
+		std::future<std::vector<uint8_t>> read_async(uint32_t offset = 0, uint32_t size = 0);
 		void bind(uint64_t offset = 0);
 		uint32_t size();
 
@@ -46,6 +50,10 @@ namespace Atlas {
 		static Buffer index_u16(uint32_t size, bool hostVisible = false);
 		static Buffer index_u32(uint32_t size, bool hostVisible = false);
 		static Buffer uniform(uint32_t size, bool hostVisible = false);
+		//extraType lets compute write e.g. vertex or index data in place
+		static Buffer storage(uint32_t size, bool hostVisible = false, BufferTypeFlags extraType = BufferType::NONE);
+		//also a storage buffer, so the draw / dispatch arguments can be written by compute
+		static Buffer indirect(uint32_t size, bool hostVisible = false);
 
 	private:
 
@@ -64,9 +64,21 @@ namespace vkutil {
 					builder.bind_image_array(binding++, vulkanTextures.data(), (uint32_t)vulkanTextures.size(),
 						VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stage);
 				}
+
+				else if (std::holds_alternative<Descriptor::StorageImageAttachment>(pair.first)) {
+					Descriptor::StorageImageAttachment image = std::get<Descriptor::StorageImageAttachment>(pair.first);
+					if (!image.texture || !image.texture->is_init()) {
+						CORE_WARN("Descriptor: storage image is not initialized!");
+						return;
+					}
+					m_Attachments.push_back(image);
+					builder.bind_image(binding++, *image.texture->get_native_texture(),
+						VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, stage);
+				}
 			}
 
 			builder.build(&m_Descriptor.set, &m_Descriptor.layout);
+			m_Descriptor.bindings = builder.get_bindings();
 		}
 
 		void update(uint32_t binding, Descriptor::Binding descBinding) {
@@ -118,14 +130,31 @@ namespace vkutil {
 						vulkanTextures.data(), (uint32_t)vulkanTextures.size(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stage);
 				}
 			}
+
+			else if (std::holds_alternative<Descriptor::StorageImageAttachment>(descBinding.first)) {
+				Descriptor::StorageImageAttachment image = std::get<Descriptor::StorageImageAttachment>(descBinding.first);
+				if (m_Attachments.at(binding).index() != descBinding.first.index()) {
+					CORE_WARN("Descriptor: binding {} can not be updated because the layout is incompatible with StorageImage!", binding);
+					return;
+				}
+				m_Attachments.at(binding) = image;
+
+				if (!m_Pushable) {
+					descriptor_update_image(Application::get_engine().manager(), &m_Descriptor.set, binding,
+						*image.texture->get_native_texture(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, stage);
+				}
+			}
 		}
 
 		void bind(Atlas::Shader &shader) {
 			CORE_ASSERT(!m_Pushable, "Descriptor: pushDescriptorFlag can not to be set");
 
+			vkutil::Shader *native = shader.get_native_shader();
+			if (!native) return;
+
 			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
-			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				shader.get_native_shader()->layout, 0, 1,
+			vkCmdBindDescriptorSets(cmd, native->bindPoint,
+				native->layout, 0, 1,
 				&m_Descriptor.set, 0, nullptr);
 		}
 
@@ -133,6 +162,9 @@ namespace vkutil {
 
 			CORE_ASSERT(m_Pushable, "Descriptor: pushDescriptorFlag has to be set");
 
+			vkutil::Shader *native = shader.get_native_shader();
+			if (!native) return;
+
 			uint32_t size = (uint32_t)m_Attachments.size();
 
 			std::vector<VkWriteDescriptorSet> writes;
@@ -180,13 +212,23 @@ namespace vkutil {
 					write.pImageInfo = it->second.data();
 				}
 
+				else if (std::holds_alternative<Descriptor::StorageImageAttachment>(at)) {
+					Descriptor::StorageImageAttachment image = std::get<Descriptor::StorageImageAttachment>(at);
+					auto info = descriptor_image_info(*image.texture->get_native_texture());
+					auto [it, ex] = imageInfos.insert({ i, info });
+
+					write.descriptorCount = 1;
+					write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+					write.pImageInfo = &it->second;
+				}
+
 				writes.push_back(write);
 			}
 
 			auto cmd = Application::get_engine().get_active_command_buffer();
 
-			Application::get_engine().vkCmdPushDescriptorSetKHR(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				shader.get_native_shader()->layout, set, (uint32_t)writes.size(), writes.data());
+			Application::get_engine().vkCmdPushDescriptorSetKHR(cmd, native->bindPoint,
+				native->layout, set, (uint32_t)writes.size(), writes.data());
 		}
 
 		VkDescriptor *get_native() {
@@ -229,11 +271,13 @@ namespace Atlas {
 	void Descriptor::bind(Shader &shader)
 	{
 		m_Descriptor->bind(shader);
+		vkutil::count(vkutil::FrameCounter::DESCRIPTOR_BINDS);
 	}
 
 	void Descriptor::push(Shader &shader, uint32_t size)
 	{
 		m_Descriptor->push(shader, size);
+		vkutil::count(vkutil::FrameCounter::DESCRIPTOR_PUSHES);
 	}
 
 	void Descriptor::update(uint32_t binding, Binding descBinding)
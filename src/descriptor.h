@@ -17,7 +17,11 @@ namespace Atlas {
 		using BufferAttachment = Ref<Buffer>;
 		using TextureAttachment = Ref<Texture>;
 		using TextureArrayAttachment = std::vector<Ref<Texture>>;
-		using Attachment = std::variant<BufferAttachment, TextureAttachment, TextureArrayAttachment>;
+		//binds the texture as a storage image instead of a sampled image, see Texture::storage
+		struct StorageImageAttachment {
+			Ref<Texture> texture;
+		};
+		using Attachment = std::variant<BufferAttachment, TextureAttachment, TextureArrayAttachment, StorageImageAttachment>;
 		using Binding = std::pair<Attachment, ShaderStage>;
 		using Bindings = std::vector<Binding>;
 
@@ -0,0 +1,332 @@
+#include "ktx2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace vkutil {
+
+	static const uint8_t c_Ktx2Identifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+
+	struct Ktx2Header {
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+	static_assert(sizeof(Ktx2Header) == 80, "KTX2 header has to match the file layout");
+
+	struct Ktx2LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	bool format_block_info(VkFormat format, FormatBlockInfo *info)
+	{
+		switch (format) {
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			*info = { 1, 1, 4 };
+			return true;
+
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+			*info = { 4, 4, 8 };
+			return true;
+
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+			*info = { 4, 4, 16 };
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	uint64_t ktx2_level_size(VkFormat format, uint32_t width, uint32_t height, uint32_t level)
+	{
+		FormatBlockInfo block;
+		if (!format_block_info(format, &block)) return 0;
+
+		uint64_t w = std::max(1u, width >> level);
+		uint64_t h = std::max(1u, height >> level);
+
+		uint64_t blocksX = (w + block.width - 1) / block.width;
+		uint64_t blocksY = (h + block.height - 1) / block.height;
+		return blocksX * blocksY * block.bytes;
+	}
+
+	bool read_ktx2(const char *file, Ktx2Image *image, std::string *error)
+	{
+		std::ifstream stream(file, std::ios::binary);
+		if (!stream.is_open()) {
+			*error = "could not open file";
+			return false;
+		}
+
+		std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		Ktx2Header header;
+		if (bytes.size() < sizeof(header)) {
+			*error = "file is too small for a KTX2 header";
+			return false;
+		}
+
+		std::memcpy(&header, bytes.data(), sizeof(header));
+
+		if (std::memcmp(header.identifier, c_Ktx2Identifier, sizeof(c_Ktx2Identifier)) != 0) {
+			*error = "not a KTX2 file";
+			return false;
+		}
+
+		//basis universal and zstd payloads need a transcoder, run them through the converter instead
+		if (header.supercompressionScheme != 0) {
+			*error = "supercompressed files are not supported, scheme: " + std::to_string(header.supercompressionScheme);
+			return false;
+		}
+
+		if (header.pixelDepth > 0 || header.layerCount > 1 || header.faceCount != 1) {
+			*error = "only single layer 2D textures are supported";
+			return false;
+		}
+
+		VkFormat format = (VkFormat)header.vkFormat;
+		FormatBlockInfo block;
+		if (!format_block_info(format, &block)) {
+			*error = "unsupported vkFormat: " + std::to_string(header.vkFormat);
+			return false;
+		}
+
+		if (header.pixelWidth == 0 || header.pixelHeight == 0) {
+			*error = "texture has no size";
+			return false;
+		}
+
+		//a level count of 0 asks the loader to generate mips, we only upload what is stored
+		uint32_t levelCount = std::max(1u, header.levelCount);
+		if (levelCount > 32 || sizeof(header) + levelCount * sizeof(Ktx2LevelIndex) > bytes.size()) {
+			*error = "level index is out of bounds";
+			return false;
+		}
+
+		image->format = format;
+		image->width = header.pixelWidth;
+		image->height = header.pixelHeight;
+		image->levels.clear();
+		image->data.clear();
+
+		for (uint32_t level = 0; level < levelCount; level++) {
+			Ktx2LevelIndex index;
+			std::memcpy(&index, bytes.data() + sizeof(header) + level * sizeof(Ktx2LevelIndex), sizeof(index));
+
+			if (index.byteOffset > bytes.size() || index.byteLength > bytes.size() - index.byteOffset) {
+				*error = "level " + std::to_string(level) + " is out of bounds";
+				return false;
+			}
+
+			if (index.byteLength != ktx2_level_size(format, image->width, image->height, level)) {
+				*error = "level " + std::to_string(level) + " has an unexpected size";
+				return false;
+			}
+
+			Ktx2Level entry;
+			entry.offset = image->data.size();
+			entry.size = index.byteLength;
+			image->levels.push_back(entry);
+
+			image->data.insert(image->data.end(), bytes.begin() + index.byteOffset,
+				bytes.begin() + index.byteOffset + index.byteLength);
+		}
+
+		return true;
+	}
+
+	enum : uint32_t {
+		DF_MODEL_RGBSDA = 1,
+		DF_MODEL_BC1A = 128,
+		DF_MODEL_BC3 = 130,
+
+		DF_PRIMARIES_BT709 = 1,
+		DF_TRANSFER_LINEAR = 1,
+		DF_TRANSFER_SRGB = 2,
+
+		DF_SAMPLE_LINEAR = 0x10,
+	};
+
+	struct DfdSample {
+		uint32_t bitOffset;
+		uint32_t bitLength;
+		uint32_t channel;
+	};
+
+	//basic data format descriptor, the spec requires one even though our reader only looks at vkFormat
+	static bool build_dfd(VkFormat format, std::vector<uint32_t> *dfd)
+	{
+		uint32_t model = 0;
+		bool srgb = false;
+		std::vector<DfdSample> samples;
+
+		switch (format) {
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			srgb = true;
+			[[fallthrough]];
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			model = DF_MODEL_RGBSDA;
+			samples = { { 0, 8, 0 }, { 8, 8, 1 }, { 16, 8, 2 }, { 24, 8, 15 } };
+			break;
+
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			srgb = true;
+			[[fallthrough]];
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			model = DF_MODEL_BC1A;
+			samples = { { 0, 64, 0 } };
+			break;
+
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			srgb = true;
+			[[fallthrough]];
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			model = DF_MODEL_BC1A;
+			samples = { { 0, 64, 15 } };
+			break;
+
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+			srgb = true;
+			[[fallthrough]];
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+			model = DF_MODEL_BC3;
+			samples = { { 0, 64, 15 }, { 64, 64, 0 } };
+			break;
+
+		default:
+			return false;
+		}
+
+		FormatBlockInfo block;
+		format_block_info(format, &block);
+
+		uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+
+		dfd->clear();
+		dfd->push_back(4 + blockSize);
+		dfd->push_back(0); //khronos vendor, basic descriptor type
+		dfd->push_back(2 | (blockSize << 16));
+		dfd->push_back(model | (DF_PRIMARIES_BT709 << 8) | ((srgb ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR) << 16));
+		dfd->push_back((block.width - 1) | ((block.height - 1) << 8));
+		dfd->push_back(block.bytes);
+		dfd->push_back(0);
+
+		for (const DfdSample &sample : samples) {
+			uint32_t channel = sample.channel;
+			//alpha stays linear in srgb formats
+			if (srgb && channel == 15) channel |= DF_SAMPLE_LINEAR;
+
+			dfd->push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (channel << 24));
+			dfd->push_back(0);
+			dfd->push_back(0);
+			dfd->push_back(model == DF_MODEL_RGBSDA ? 255 : 0xFFFFFFFF);
+		}
+
+		return true;
+	}
+
+	bool write_ktx2(const char *file, const Ktx2Image &image, std::string *error)
+	{
+		std::vector<uint32_t> dfd;
+		if (!build_dfd(image.format, &dfd)) {
+			*error = "can not write vkFormat: " + std::to_string(image.format);
+			return false;
+		}
+
+		FormatBlockInfo block;
+		format_block_info(image.format, &block);
+
+		uint32_t levelCount = (uint32_t)image.levels.size();
+
+		Ktx2Header header{};
+		std::memcpy(header.identifier, c_Ktx2Identifier, sizeof(c_Ktx2Identifier));
+		header.vkFormat = (uint32_t)image.format;
+		header.typeSize = 1;
+		header.pixelWidth = image.width;
+		header.pixelHeight = image.height;
+		header.faceCount = 1;
+		header.levelCount = levelCount;
+
+		header.dfdByteOffset = (uint32_t)(sizeof(header) + levelCount * sizeof(Ktx2LevelIndex));
+		header.dfdByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t));
+
+		//levels are aligned to lcm(texel block size, 4) and stored smallest first
+		uint64_t alignment = block.bytes % 4 == 0 ? block.bytes : block.bytes * 4;
+
+		std::vector<Ktx2LevelIndex> index(levelCount);
+		uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+
+		for (uint32_t i = levelCount; i-- > 0;) {
+			const Ktx2Level &level = image.levels[i];
+
+			if (level.size != ktx2_level_size(image.format, image.width, image.height, i)
+				|| level.offset + level.size > image.data.size()) {
+				*error = "level " + std::to_string(i) + " has an unexpected size";
+				return false;
+			}
+
+			offset = (offset + alignment - 1) / alignment * alignment;
+			index[i] = { offset, level.size, level.size };
+			offset += level.size;
+		}
+
+		std::vector<uint8_t> bytes(offset, 0);
+		std::memcpy(bytes.data(), &header, sizeof(header));
+		std::memcpy(bytes.data() + sizeof(header), index.data(), index.size() * sizeof(Ktx2LevelIndex));
+		std::memcpy(bytes.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+
+		for (uint32_t i = 0; i < levelCount; i++) {
+			std::memcpy(bytes.data() + index[i].byteOffset, image.data.data() + image.levels[i].offset, image.levels[i].size);
+		}
+
+		std::ofstream stream(file, std::ios::binary);
+		if (!stream.is_open()) {
+			*error = "could not open file for writing";
+			return false;
+		}
+
+		stream.write((const char *)bytes.data(), bytes.size());
+		return true;
+	}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// minimal KTX2 container support, only 2D textures without supercompression.
+// shared between the engine and the offline converter in tools/, so it doesn't depend on the logger
+namespace vkutil {
+
+	struct Ktx2Level {
+		uint64_t offset{ 0 }; //relative to Ktx2Image::data
+		uint64_t size{ 0 };
+	};
+
+	struct Ktx2Image {
+		VkFormat format{ VK_FORMAT_UNDEFINED };
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+
+		//level 0 is the full resolution image
+		std::vector<Ktx2Level> levels;
+		std::vector<uint8_t> data;
+	};
+
+	struct FormatBlockInfo {
+		uint32_t width{ 1 };
+		uint32_t height{ 1 };
+		uint32_t bytes{ 0 };
+	};
+
+	//formats the loader knows how to size, returns false for everything else
+	bool format_block_info(VkFormat format, FormatBlockInfo *info);
+	//expected byte size of a single mip level
+	uint64_t ktx2_level_size(VkFormat format, uint32_t width, uint32_t height, uint32_t level);
+
+	bool read_ktx2(const char *file, Ktx2Image *image, std::string *error);
+	bool write_ktx2(const char *file, const Ktx2Image &image, std::string *error);
+
+}
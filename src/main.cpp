@@ -2,6 +2,8 @@
 #include "texture.h"
 #include "buffer.h"
 #include "renderer.h"
+#include "render_api.h"
+#include "particles.h"
 #include "orthographic_camera.h"
 #include "perspective_camera.h"
 
@@ -13,9 +15,11 @@ class Sandbox : public Atlas::Layer {
 	Atlas::OrthographicCameraController orthoCamera;
 
 	Ref<Atlas::Texture> tex;
+	Scope<Atlas::ParticleSystem> particles;
 
 	void on_attach() override {
-		tex = make_ref<Atlas::Texture>("res/images/uv_checker_v2.png", Atlas::FilterOptions::NEAREST);
+		tex = Atlas::Texture::load_async("res/images/uv_checker_v2.png", Atlas::FilterOptions::NEAREST);
+		particles = make_scope<Atlas::ParticleSystem>(Atlas::ParticleSystemInfo{});
 	}
 
 	void on_update(Atlas::Timestep ts) override {
@@ -23,6 +27,9 @@ class Sandbox : public Atlas::Layer {
 
 		orthoCamera.on_update(ts);
 
+		//simulated on the compute queue while the 2D passes below render
+		particles->update(ts);
+
 		Render2D::set_camera(orthoCamera.get_camera());
 
 
@@ -47,6 +54,11 @@ class Sandbox : public Atlas::Layer {
 		Render2D::begin(Application::get_viewport_color_texture());
 		Render2D::circle({ 1 , 1 }, 0.5, Color(0, 0, 200));
 		Render2D::end();
+
+		RenderApi::sync_async_compute();
+		RenderApi::begin(Application::get_viewport_color_texture(), Color(0, 0, 0, 0));
+		particles->draw(orthoCamera.get_camera());
+		RenderApi::end();
 	}
 
 	void on_event(Atlas::Event &e) override {
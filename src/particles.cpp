@@ -0,0 +1,213 @@
+#include "particles.h"
+#include "application.h"
+#include "camera.h"
+#include "render_api.h"
+
+namespace Atlas {
+
+	//matches the push constants of particles.comp
+	struct ParticleComputeConstants {
+		glm::vec4 color;
+		glm::vec2 emitterPosition;
+		glm::vec2 gravity;
+		float spread;
+		float speed;
+		float lifetime;
+		float dt;
+		uint32_t emitCount;
+		uint32_t seed;
+		uint32_t current;
+		uint32_t maxParticles;
+	};
+
+	//matches the push constants of instance.vert
+	struct ParticleDrawConstants {
+		glm::mat4 viewProj;
+		glm::vec4 color;
+		float size;
+		float lifetime;
+		uint32_t current;
+		uint32_t maxParticles;
+	};
+
+	struct ParticleCounters {
+		int32_t aliveCount[2];
+		int32_t deadCount;
+	};
+
+	enum ParticlePass : uint32_t {
+		EMIT = 0,
+		PREPARE_SIMULATE = 1,
+		SIMULATE = 2,
+		PREPARE_DRAW = 3,
+	};
+
+	static const uint32_t PARTICLE_GROUP_SIZE = 64;
+	//VkDispatchIndirectCommand at 0, VkDrawIndirectCommand at 16
+	static const uint32_t DISPATCH_ARGS_OFFSET = 0;
+	static const uint32_t DRAW_ARGS_OFFSET = 16;
+
+	static Ref<Buffer> create_storage_buffer(uint32_t size)
+	{
+		Ref<Buffer> buffer = make_ref<Buffer>();
+		*buffer = Buffer::storage(size);
+		return buffer;
+	}
+
+	ParticleSystem::ParticleSystem(const ParticleSystemInfo &info)
+		:m_Info(info)
+	{
+		ATL_EVENT();
+
+		uint32_t count = m_Info.maxParticles;
+		if (count == 0) {
+			CORE_WARN("ParticleSystem: maxParticles has to be greater than 0");
+			return;
+		}
+
+		m_Positions = create_storage_buffer(count * (uint32_t)sizeof(glm::vec2));
+		m_Velocities = create_storage_buffer(count * (uint32_t)sizeof(glm::vec2));
+		m_Lifetimes = create_storage_buffer(count * (uint32_t)sizeof(float));
+		m_AliveLists = create_storage_buffer(2 * count * (uint32_t)sizeof(uint32_t));
+		m_DeadList = create_storage_buffer(count * (uint32_t)sizeof(uint32_t));
+		m_Counters = create_storage_buffer((uint32_t)sizeof(ParticleCounters));
+
+		m_IndirectArgs = make_ref<Buffer>();
+		*m_IndirectArgs = Buffer::indirect(DRAW_ARGS_OFFSET + 4 * (uint32_t)sizeof(uint32_t));
+
+		//every particle starts out dead
+		std::vector<uint32_t> dead(count);
+		for (uint32_t i = 0; i < count; i++) dead[i] = i;
+		m_DeadList->set_data(dead.data(), count * (uint32_t)sizeof(uint32_t));
+
+		ParticleCounters counters{ { 0, 0 }, (int32_t)count };
+		m_Counters->set_data(&counters, (uint32_t)sizeof(ParticleCounters));
+
+		std::array<uint32_t, 8> args = { 0, 1, 1, 0, 6, 0, 0, 0 };
+		m_IndirectArgs->set_data(args.data(), (uint32_t)sizeof(args));
+
+		Descriptor::Bindings computeBindings = {
+			{ m_Positions, ShaderStage::COMPUTE },
+			{ m_Velocities, ShaderStage::COMPUTE },
+			{ m_Lifetimes, ShaderStage::COMPUTE },
+			{ m_AliveLists, ShaderStage::COMPUTE },
+			{ m_DeadList, ShaderStage::COMPUTE },
+			{ m_Counters, ShaderStage::COMPUTE },
+			{ m_IndirectArgs, ShaderStage::COMPUTE },
+		};
+		m_ComputeDescriptor = Descriptor(computeBindings);
+
+		//bindings keep the numbering of the compute set, so the shaders can share the declarations
+		Descriptor::Bindings drawBindings = {
+			{ m_Positions, ShaderStage::VERTEX },
+			{ m_Velocities, ShaderStage::VERTEX },
+			{ m_Lifetimes, ShaderStage::VERTEX },
+			{ m_AliveLists, ShaderStage::VERTEX },
+		};
+		m_DrawDescriptor = Descriptor(drawBindings);
+
+		auto compLoad = ShaderModule::load_async("res/shaders/particles.comp", ShaderStage::COMPUTE, true);
+		auto vertLoad = ShaderModule::load_async("res/shaders/instance.vert", ShaderStage::VERTEX, true);
+		auto fragLoad = ShaderModule::load_async("res/shaders/instance.frag", ShaderStage::FRAGMENT, true);
+
+		std::optional<ShaderModule> compModule = compLoad.get();
+		std::optional<ShaderModule> vertModule = vertLoad.get();
+		std::optional<ShaderModule> fragModule = fragLoad.get();
+
+		if (!compModule.has_value() || !vertModule.has_value() || !fragModule.has_value()) {
+			CORE_WARN("ParticleSystem: could not load the particle shaders");
+			return;
+		}
+
+		//one source, the pass is selected by a specialization constant
+		for (uint32_t pass = 0; pass < (uint32_t)m_Passes.size(); pass++) {
+			ShaderCreateInfo passInfo{};
+			passInfo.modules = { compModule.value() };
+			passInfo.descriptors = { m_ComputeDescriptor };
+			passInfo.specializationConstants = { { 0, pass } };
+
+			m_Passes[pass] = Shader(passInfo);
+		}
+
+		ShaderCreateInfo drawInfo{};
+		drawInfo.modules = { vertModule.value(), fragModule.value() };
+		drawInfo.descriptors = { m_DrawDescriptor };
+		m_DrawShader = Shader(drawInfo);
+
+		m_Initialized = true;
+	}
+
+	void ParticleSystem::run_pass(uint32_t pass, uint32_t groupCount)
+	{
+		Shader &shader = m_Passes[pass];
+		shader.bind();
+		m_ComputeDescriptor.bind(shader);
+
+		ParticleComputeConstants constants{};
+		constants.color = m_Info.color.normalized_vec();
+		constants.emitterPosition = m_EmitterPosition;
+		constants.gravity = m_Info.gravity;
+		constants.spread = m_Info.spread;
+		constants.speed = m_Info.speed;
+		constants.lifetime = m_Info.lifetime;
+		constants.dt = m_LastTimestep;
+		constants.emitCount = m_EmitCount;
+		constants.seed = m_Seed;
+		constants.current = m_Current;
+		constants.maxParticles = m_Info.maxParticles;
+		RenderApi::push_constants(shader, constants);
+
+		//the simulate pass is sized by the alive count, which only the GPU knows
+		if (pass == ParticlePass::SIMULATE) RenderApi::dispatch_indirect(*m_IndirectArgs, DISPATCH_ARGS_OFFSET);
+		else RenderApi::dispatch(groupCount);
+	}
+
+	void ParticleSystem::update(Timestep ts)
+	{
+		if (!m_Initialized) return;
+
+		ATL_EVENT();
+
+		m_LastTimestep = ts;
+
+		m_EmitAccumulator += m_Info.emitRate * ts;
+		m_EmitCount = (uint32_t)std::min(m_EmitAccumulator, (float)m_Info.maxParticles);
+		m_EmitAccumulator -= (float)m_EmitCount;
+		m_Seed++;
+
+		RenderApi::begin_async_compute({ m_Positions, m_Velocities, m_Lifetimes, m_AliveLists, m_DeadList,
+			m_Counters, m_IndirectArgs });
+
+		if (m_EmitCount > 0) run_pass(ParticlePass::EMIT, (m_EmitCount + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE);
+		run_pass(ParticlePass::PREPARE_SIMULATE, 1);
+		run_pass(ParticlePass::SIMULATE, 0);
+		run_pass(ParticlePass::PREPARE_DRAW, 1);
+
+		RenderApi::end_async_compute();
+
+		//the survivors were appended to the other alive list
+		m_Current = 1 - m_Current;
+	}
+
+	void ParticleSystem::draw(Camera &camera)
+	{
+		if (!m_Initialized) return;
+
+		GPU_SCOPE("ParticleSystem::draw");
+
+		m_DrawShader.bind();
+		m_DrawDescriptor.bind(m_DrawShader);
+
+		ParticleDrawConstants constants{};
+		constants.viewProj = camera.get_view_projection();
+		constants.color = m_Info.color.normalized_vec();
+		constants.size = m_Info.size;
+		constants.lifetime = m_Info.lifetime;
+		constants.current = m_Current;
+		constants.maxParticles = m_Info.maxParticles;
+		RenderApi::push_constants(m_DrawShader, constants);
+
+		RenderApi::draw_indirect(*m_IndirectArgs, DRAW_ARGS_OFFSET);
+	}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "buffer.h"
+#include "descriptor.h"
+#include "shader.h"
+#include "texture.h"
+#include "layer.h"
+
+namespace Atlas {
+
+	class Camera;
+
+	struct ParticleSystemInfo {
+		uint32_t maxParticles{ 1 << 20 };
+		float emitRate{ 20000.0f }; //particles per second
+		float lifetime{ 3.0f }; //seconds, every particle gets between half and all of it
+		float speed{ 2.0f };
+		float spread{ 0.4f }; //radians around +y
+		float size{ 0.01f };
+		glm::vec2 gravity{ 0.0f, -1.0f };
+		Color color{ 255, 140, 30 };
+	};
+
+	//particle state only lives on the GPU: emit, simulate and compaction run as compute passes
+	//and the particles are drawn with an indirect draw, the CPU never reads it back
+	class ParticleSystem {
+	public:
+
+		ParticleSystem() = default;
+		ParticleSystem(const ParticleSystemInfo &info);
+
+		//runs on the async compute queue, can be called inside of a render pass
+		void update(Timestep ts);
+		//has to be called inside a render pass, after update and RenderApi::sync_async_compute
+		void draw(Camera &camera);
+
+		inline void set_emitter(const glm::vec2 &position) { m_EmitterPosition = position; }
+		inline ParticleSystemInfo &get_info() { return m_Info; }
+		inline bool is_init() { return m_Initialized; }
+
+	private:
+
+		void run_pass(uint32_t pass, uint32_t groupCount);
+
+		ParticleSystemInfo m_Info{};
+		bool m_Initialized{ false };
+
+		glm::vec2 m_EmitterPosition{ 0.0f };
+		float m_EmitAccumulator{ 0.0f };
+		uint32_t m_EmitCount{ 0 };
+		float m_LastTimestep{ 0.0f };
+		uint32_t m_Seed{ 0 };
+		uint32_t m_Current{ 0 };
+
+		//structure of arrays, one entry per particle
+		Ref<Buffer> m_Positions;
+		Ref<Buffer> m_Velocities;
+		Ref<Buffer> m_Lifetimes;
+		Ref<Buffer> m_AliveLists;
+		Ref<Buffer> m_DeadList;
+		Ref<Buffer> m_Counters;
+		Ref<Buffer> m_IndirectArgs;
+
+		Descriptor m_ComputeDescriptor;
+		Descriptor m_DrawDescriptor;
+
+		std::array<Shader, 4> m_Passes;
+		Shader m_DrawShader;
+	};
+
+}
@@ -14,11 +14,21 @@
 #include <set>
 #include <unordered_set>
 #include <type_traits>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #include <functional>
 #include <utility>
 #include <optional>
 #include <variant>
 
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <condition_variable>
+
 #include "utils.h"
 #include "logger.h"
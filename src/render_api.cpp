@@ -2,6 +2,10 @@
 #include "application.h"
 
 #include "vk_engine.h"
+#include "atl_vk_utils.h"
+#include "shader.h"
+#include "buffer.h"
+#include "vk_types.h"
 
 namespace Atlas {
 
@@ -23,11 +27,145 @@ namespace Atlas {
 			Application::get_engine().end_renderpass();
 		}
 
+		void set_cull_mode(CullMode mode, bool clockwise)
+		{
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdSetCullMode(cmd, atlas_to_vk_cull_mode(mode));
+			vkCmdSetFrontFace(cmd, clockwise ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE);
+		}
+
+		void set_depth_test(bool test, bool write, CompareOp op)
+		{
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdSetDepthTestEnable(cmd, test);
+			vkCmdSetDepthWriteEnable(cmd, write);
+			vkCmdSetDepthCompareOp(cmd, atlas_to_vk_compare_op(op));
+		}
+
+		void set_topology(Topology topology, bool primitiveRestart)
+		{
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdSetPrimitiveTopology(cmd, atlas_to_vk_topology(topology));
+			vkCmdSetPrimitiveRestartEnable(cmd, primitiveRestart);
+		}
+
+		void set_blend_mode(BlendMode mode)
+		{
+			vkutil::VulkanEngine &engine = Application::get_engine();
+
+			//the device selection already warned about it
+			if (!engine.has_dynamic_blend()) return;
+
+			VkCommandBuffer cmd = engine.get_active_command_buffer();
+
+			VkBool32 enable = mode != BlendMode::NONE;
+			engine.vkCmdSetColorBlendEnableEXT(cmd, 0, 1, &enable);
+
+			if (!enable) return;
+
+			VkColorBlendEquationEXT equation{};
+			equation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			equation.dstColorBlendFactor = mode == BlendMode::ADDITIVE ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			equation.colorBlendOp = VK_BLEND_OP_ADD;
+			equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			equation.alphaBlendOp = VK_BLEND_OP_ADD;
+
+			engine.vkCmdSetColorBlendEquationEXT(cmd, 0, 1, &equation);
+		}
+
+		void push_constants(Shader &shader, const void *data, uint32_t size, uint32_t offset)
+		{
+			vkutil::Shader *native = shader.get_native_shader();
+			if (!native) return;
+
+			//every stage whose range overlaps the update has to be listed
+			VkShaderStageFlags stages = 0;
+			for (auto &r : native->pushConstants) {
+				if (offset < r.offset + r.size && r.offset < offset + size) stages |= r.stageFlags;
+			}
+
+			if (stages == 0) {
+				CORE_WARN("RenderApi: push constants [{}, {}) are not used by the shader", offset, offset + size);
+				return;
+			}
+
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdPushConstants(cmd, native->layout, stages, offset, size, data);
+		}
+
+		void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+		{
+			Application::get_engine().dispatch(groupCountX, groupCountY, groupCountZ);
+		}
+
+		void dispatch_indirect(Buffer &buffer, uint64_t offset)
+		{
+			if (!(buffer.get_type() & BufferType::INDIRECT)) {
+				CORE_WARN("RenderApi: dispatch_indirect needs a buffer with BufferType::INDIRECT");
+				return;
+			}
+
+			Application::get_engine().dispatch_indirect(buffer.get_native_buffer()->buffer, offset);
+		}
+
+		void begin_async_compute(const std::vector<Ref<Buffer>> &buffers)
+		{
+			std::vector<VkBuffer> nativeBuffers;
+			nativeBuffers.reserve(buffers.size());
+
+			for (auto &buffer : buffers) {
+				if (buffer && buffer->is_init()) nativeBuffers.push_back(buffer->get_native_buffer()->buffer);
+			}
+
+			Application::get_engine().begin_async_compute(nativeBuffers);
+		}
+
+		void end_async_compute()
+		{
+			Application::get_engine().end_async_compute();
+		}
+
+		void sync_async_compute()
+		{
+			Application::get_engine().sync_async_compute();
+		}
+
+		void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+		{
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdDraw(cmd, vertexCount, instanceCount, firstVertex, firstInstance);
+			vkutil::count(vkutil::FrameCounter::DRAWS);
+		}
+
+		void draw_indirect(Buffer &buffer, uint64_t offset, uint32_t drawCount, uint32_t stride)
+		{
+			if (!(buffer.get_type() & BufferType::INDIRECT)) {
+				CORE_WARN("RenderApi: draw_indirect needs a buffer with BufferType::INDIRECT");
+				return;
+			}
+
+			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
+			vkCmdDrawIndirect(cmd, buffer.get_native_buffer()->buffer, offset, drawCount, stride);
+			vkutil::count(vkutil::FrameCounter::DRAWS, drawCount);
+		}
+
 		void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
 		{
 			VkCommandBuffer cmd = Application::get_engine().get_active_command_buffer();
 			vkCmdDrawIndexed(cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+			vkutil::count(vkutil::FrameCounter::DRAWS);
 		}
 	}
 
+	GpuScope::GpuScope(const char *name)
+		: m_Scope(Application::get_engine().begin_gpu_scope(name))
+	{
+	}
+
+	GpuScope::~GpuScope()
+	{
+		Application::get_engine().end_gpu_scope(m_Scope);
+	}
+
 }
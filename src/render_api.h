@@ -5,11 +5,90 @@
 
 namespace Atlas {
 
+	class Shader;
+	class Buffer;
+
+	enum class CullMode {
+		NONE,
+		FRONT,
+		BACK,
+	};
+
+	enum class CompareOp {
+		NEVER,
+		LESS,
+		EQUAL,
+		LESS_OR_EQUAL,
+		GREATER,
+		NOT_EQUAL,
+		GREATER_OR_EQUAL,
+		ALWAYS,
+	};
+
+	//pipelines are built for triangles, only topologies of the same class can be set
+	enum class Topology {
+		TRIANGLE_LIST,
+		TRIANGLE_STRIP,
+	};
+
+	enum class BlendMode {
+		NONE,
+		ALPHA,
+		ADDITIVE,
+	};
+
 	namespace RenderApi {
 		void begin(Ref<Texture> color, Ref<Texture> depth, Color clearColor);
 		void begin(Ref<Texture> color, Color clearColor, bool clearScreen = false);
 		void end();
 
+		//binding a shader resets these to: no culling, depth test + write with LESS_OR_EQUAL, triangle list, alpha blending
+		void set_cull_mode(CullMode mode, bool clockwise = true);
+		void set_depth_test(bool test, bool write, CompareOp op = CompareOp::LESS_OR_EQUAL);
+		void set_topology(Topology topology, bool primitiveRestart = false);
+		//only supported with VK_EXT_extended_dynamic_state3, otherwise alpha blending is used
+		void set_blend_mode(BlendMode mode);
+
+		//updates [offset, offset + size) of the push constants of the bound shader
+		void push_constants(Shader &shader, const void *data, uint32_t size, uint32_t offset = 0);
+
+		template<typename T>
+		void push_constants(Shader &shader, const T &data, uint32_t offset = 0) {
+			push_constants(shader, &data, (uint32_t)sizeof(T), offset);
+		}
+
+		//the bound shader has to be a compute shader, see Shader::compute
+		void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+		//reads a VkDispatchIndirectCommand (3 x uint32) at offset, the buffer needs BufferType::INDIRECT
+		void dispatch_indirect(Buffer &buffer, uint64_t offset = 0);
+
+		//dispatches until end_async_compute run on the compute queue, next to the graphics work (inline if there is none)
+		//buffers are the ones the dispatches access, graphics may only use them again after sync_async_compute
+		void begin_async_compute(const std::vector<Ref<Buffer>> &buffers = {});
+		void end_async_compute();
+		//graphics work recorded afterwards waits for the async compute work, has to be called outside of a render pass
+		void sync_async_compute();
+
+		void draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+		//reads drawCount VkDrawIndirectCommand (4 x uint32) starting at offset, the buffer needs BufferType::INDIRECT
+		void draw_indirect(Buffer &buffer, uint64_t offset = 0, uint32_t drawCount = 1, uint32_t stride = 16);
 		void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0);
 	}
+
+	//measures the gpu time of the work recorded during its lifetime, shown in the Metrics window a few frames later
+	class GpuScope {
+	public:
+		//name has to outlive the frame, e.g. a string literal
+		GpuScope(const char *name);
+		~GpuScope();
+
+		GpuScope(const GpuScope &other) = delete;
+
+	private:
+		uint32_t m_Scope;
+	};
 }
+
+#define ATL_CONCAT_IMPL(a, b) a##b
+#define ATL_CONCAT(a, b) ATL_CONCAT_IMPL(a, b)
+#define GPU_SCOPE(name) ::Atlas::GpuScope ATL_CONCAT(gpuScope, __LINE__)(name)
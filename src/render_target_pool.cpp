@@ -0,0 +1,78 @@
+#include "render_target_pool.h"
+#include "application.h"
+#include "atl_vk_utils.h"
+
+#include "vk_engine.h"
+
+namespace Atlas {
+
+	static const uint32_t c_BucketSize = 128;
+	static const uint64_t c_ExpireFrames = 120;
+
+	Ref<Texture> RenderTargetPool::acquire(uint32_t width, uint32_t height, TextureFormat format)
+	{
+		Key key{};
+		key.format = format;
+		key.usage = color_format_to_texture_info(format, 1, 1).usageFlags;
+		key.width = bucket_size(width);
+		key.height = bucket_size(height);
+
+		Ref<Texture> texture;
+
+		for (auto it = m_Free.begin(); it != m_Free.end(); it++) {
+			if (!(it->key == key)) continue;
+
+			texture = it->texture;
+			m_Free.erase(it);
+			break;
+		}
+
+		if (!texture) texture = make_ref<Texture>(key.width, key.height, format);
+
+		m_Acquired[texture.get()] = key;
+		texture->set_render_extent(width, height);
+		return texture;
+	}
+
+	void RenderTargetPool::release(Ref<Texture> &texture)
+	{
+		if (!texture) return;
+
+		auto it = m_Acquired.find(texture.get());
+		if (it == m_Acquired.end()) {
+			CORE_WARN("RenderTargetPool: {}x{} texture was not acquired from the pool", texture->width(), texture->height());
+			texture = nullptr;
+			return;
+		}
+
+		m_Free.push_back({ texture, it->second, m_Frame });
+		m_Acquired.erase(it);
+		texture = nullptr;
+	}
+
+	void RenderTargetPool::update()
+	{
+		m_Frame++;
+
+		m_Free.erase(std::remove_if(m_Free.begin(), m_Free.end(), [&](const Entry &entry) {
+			return m_Frame - entry.releasedFrame > c_ExpireFrames;
+		}), m_Free.end());
+	}
+
+	void RenderTargetPool::clear()
+	{
+		m_Free.clear();
+		m_Acquired.clear();
+	}
+
+	bool RenderTargetPool::Key::operator==(const Key &other) const
+	{
+		return format == other.format && usage == other.usage && width == other.width && height == other.height;
+	}
+
+	uint32_t RenderTargetPool::bucket_size(uint32_t size)
+	{
+		return std::max(1u, (size + c_BucketSize - 1) / c_BucketSize) * c_BucketSize;
+	}
+
+}
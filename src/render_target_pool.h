@@ -0,0 +1,46 @@
+#pragma once
+
+#include "texture.h"
+
+namespace Atlas {
+
+	// keeps render targets around for reuse. sizes are rounded up to buckets, so targets that are resized by a few
+	// pixels land on the same allocation and only their render extent changes
+	class RenderTargetPool {
+	public:
+
+		//the returned texture is at least width x height, its render extent is set to exactly that
+		Ref<Texture> acquire(uint32_t width, uint32_t height, TextureFormat format);
+		//the texture can be handed out again, it is destroyed if nobody acquired it for a while
+		void release(Ref<Texture> &texture);
+
+		//once per frame, destroys targets that have not been acquired for c_ExpireFrames
+		void update();
+		void clear();
+
+		static uint32_t bucket_size(uint32_t size);
+
+	private:
+
+		//textures are only handed out again for the exact key they were created for
+		struct Key {
+			TextureFormat format;
+			uint32_t usage; //VkImageUsageFlags
+			uint32_t width, height;
+
+			bool operator==(const Key &other) const;
+		};
+
+		struct Entry {
+			Ref<Texture> texture;
+			Key key;
+			uint64_t releasedFrame;
+		};
+
+		std::vector<Entry> m_Free;
+		//the key of every texture that is handed out, release files it under it
+		std::unordered_map<Texture *, Key> m_Acquired;
+		uint64_t m_Frame{ 0 };
+	};
+
+}
@@ -23,7 +23,9 @@ namespace Atlas {
 		//const uint32_t maxIndices{ 300 };
 		static const uint32_t MAX_VERTICES = 6000;
 		static const uint32_t MAX_INDICES = 100000;
-		static const uint32_t MAX_TEXTURE_SLOTS = 25;
+		//upper bound, the actual slot count depends on the device limits
+		static const uint32_t MAX_TEXTURE_SLOTS = 32;
+		uint32_t textureSlotCount{ 0 };
 
 		Shader defaultShader;
 		Descriptor defaultDescriptor;
@@ -31,7 +33,7 @@ namespace Atlas {
 		Buffer vertexBuffer;
 		Buffer indexBuffer;
 
-		Ref<Buffer> cameraBuffer;
+		//pushed with every flush instead of living in a uniform buffer
 		GPUCameraData camera{};
 
 		std::array<Render2D::Vertex, MAX_VERTICES> vertices{ Render2D::Vertex() };
@@ -112,7 +114,17 @@ namespace Atlas {
 		s_Data.vertexPtr = s_Data.vertices.data();
 		s_Data.indexPtr = s_Data.indices.data();
 
-		s_Data.textureSlots.resize(RenderData::MAX_TEXTURE_SLOTS);
+		{
+			//all slots are pushed together, so they have to fit into a single push descriptor set
+			vkutil::VulkanEngine &engine = Application::get_engine();
+			const VkPhysicalDeviceLimits &limits = engine.get_gpu_properties().limits;
+
+			s_Data.textureSlotCount = std::min({ RenderData::MAX_TEXTURE_SLOTS,
+				limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages,
+				engine.get_max_push_descriptors() });
+		}
+
+		s_Data.textureSlots.resize(s_Data.textureSlotCount);
 		//s_Data.vertices = std::vector<Vertex>(s_Data.vertexCount, Vertex());
 		//s_Data.indices = std::vector<uint16_t>(s_Data.indexCount, 0);
 
@@ -124,12 +136,7 @@ namespace Atlas {
 			.push_attrib(VertexAttribute::INT, &Vertex::texID)
 			.push_attrib(VertexAttribute::FLOAT, &Vertex::sqrRadius);
 
-		GPUCameraData gpuCamera{};
-		gpuCamera.viewProj = OrthographicCamera(-1, 1, -1, 1).get_view_projection();
-
-		s_Data.cameraBuffer = make_ref<Buffer>();
-		*s_Data.cameraBuffer = Buffer::uniform((uint32_t)sizeof(gpuCamera), true);
-		s_Data.cameraBuffer->set_data(&gpuCamera, sizeof(GPUCameraData));
+		s_Data.camera.viewProj = OrthographicCamera(-1, 1, -1, 1).get_view_projection();
 
 		{
 			s_Data.whiteTexture = make_ref<Texture>(1, 1, FilterOptions::NEAREST);
@@ -140,19 +147,23 @@ namespace Atlas {
 		}
 
 		Descriptor::Bindings bindings = {
-			{s_Data.cameraBuffer, ShaderStage::VERTEX},
 			{s_Data.textureSlots, ShaderStage::FRAGMENT},
 		};
 
 		s_Data.defaultDescriptor = Descriptor(bindings, true);
 
-		ShaderModule vertModule = ShaderModule::load("res/shaders/default.vert", ShaderStage::VERTEX, true).value();
-		ShaderModule fragModule = ShaderModule::load("res/shaders/default.frag", ShaderStage::FRAGMENT, true).value();
+		auto vertLoad = ShaderModule::load_async("res/shaders/default.vert", ShaderStage::VERTEX, true);
+		auto fragLoad = ShaderModule::load_async("res/shaders/default.frag", ShaderStage::FRAGMENT, true);
+
+		ShaderModule vertModule = vertLoad.get().value();
+		ShaderModule fragModule = fragLoad.get().value();
 
 		ShaderCreateInfo shaderInfo{};
 		shaderInfo.modules = { vertModule, fragModule };
 		shaderInfo.vertexDescription = vertexDescription;
 		shaderInfo.descriptors = { s_Data.defaultDescriptor };
+		shaderInfo.specializationConstants = { { 0, s_Data.textureSlotCount } };
+		shaderInfo.pushConstants = { { { ShaderStage::VERTEX }, 0, (uint32_t)sizeof(GPUCameraData) } };
 
 		s_Data.defaultShader = Shader(shaderInfo);
 
@@ -182,6 +193,8 @@ namespace Atlas {
 
 		if (s_Data.indexCount == 0) return;
 
+		GPU_SCOPE("Render2D::flush");
+
 		RenderApi::end();
 
 		s_Data.vertexBuffer.set_data(s_Data.vertices.data(), s_Data.vertexCount * sizeof(Vertex));
@@ -193,8 +206,9 @@ namespace Atlas {
 		s_Data.vertexBuffer.bind();
 		s_Data.indexBuffer.bind();
 
-		s_Data.defaultDescriptor.update(1, { s_Data.textureSlots, ShaderStage::FRAGMENT });
+		s_Data.defaultDescriptor.update(0, { s_Data.textureSlots, ShaderStage::FRAGMENT });
 		s_Data.defaultDescriptor.push(s_Data.defaultShader, 0);
+		RenderApi::push_constants(s_Data.defaultShader, s_Data.camera);
 
 		//RenderApi::end();
 		//RenderApi::begin(s_Data.renderColorTarget, { 0, 0, 0, 0 });
@@ -215,10 +229,7 @@ namespace Atlas {
 
 	void Render2D::set_camera(Camera &camera)
 	{
-		if (s_Data.camera.viewProj != camera.get_view_projection()) {
-			s_Data.camera.viewProj = camera.get_view_projection();
-			s_Data.cameraBuffer->set_data(&s_Data.camera, sizeof(GPUCameraData));
-		}
+		s_Data.camera.viewProj = camera.get_view_projection();
 	}
 
 	void Render2D::rect(const glm::vec2 &pos, const glm::vec2 &size, Color color, uint32_t textureIndx, float radius)
@@ -294,8 +305,8 @@ namespace Atlas {
 			}
 		}
 
-		if (textureIndx == 0 && s_Data.textureSlotIndex + 1 > RenderData::MAX_TEXTURE_SLOTS) {
-			CORE_WARN("Render2D: not more than {} texture slots supported!", RenderData::MAX_TEXTURE_SLOTS);
+		if (textureIndx == 0 && s_Data.textureSlotIndex + 1 > s_Data.textureSlotCount) {
+			CORE_WARN("Render2D: not more than {} texture slots supported!", s_Data.textureSlotCount);
 			return;
 		}
 
@@ -304,6 +315,15 @@ namespace Atlas {
 			s_Data.textureSlots[textureIndx] = texture;
 		}
 
+		//size on screen in pixels, lets the residency manager drop mips this rect doesn't need
+		if (s_Data.renderColorTarget) {
+			const glm::mat4 &viewProj = s_Data.camera.viewProj;
+			glm::uvec2 extent = s_Data.renderColorTarget->get_render_extent();
+			float screenWidth = std::abs(viewProj[0][0] * size.x) * 0.5f * extent.x;
+			float screenHeight = std::abs(viewProj[1][1] * size.y) * 0.5f * extent.y;
+			texture->mark_used(std::max(screenWidth, screenHeight));
+		}
+
 		rect(pos, size, tint, textureIndx, 2);
 	}
 
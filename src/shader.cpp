@@ -12,52 +12,140 @@ namespace vkutil {
 	public:
 
 		VulkanShader(Atlas::ShaderCreateInfo &info)
-			//:m_Descriptors(info.descriptors)
+		{
+			m_Shader = build(info);
+		}
+
+		//builds the pipeline on the thread pool, the fallback is used until it is done
+		VulkanShader(Atlas::ShaderCreateInfo info, Ref<VulkanShader> fallback)
+			:m_Fallback(fallback)
+		{
+			m_Pending = Atlas::Application::get_thread_pool().submit([info]() mutable {
+				return build(info);
+			});
+		}
+
+		~VulkanShader()
+		{
+			vkutil::AssetManager &assets = Atlas::Application::get_engine().asset_manager();
+
+			//the pipeline might still be in flight on a worker, wait for it so it can be released
+			if (m_Pending.valid()) {
+				Ref<vkutil::Shader> shader = m_Pending.get();
+				if (shader) assets.release_shader(shader);
+			}
+
+			if (auto shared = m_Shader.lock()) {
+				assets.release_shader(shared);
+			}
+		}
+
+		//shaders with the same pipeline state share one pipeline through the asset manager
+		static Ref<vkutil::Shader> build(Atlas::ShaderCreateInfo &info)
 		{
 			vkutil::VulkanEngine &engine = Atlas::Application::get_engine();
 			vkutil::VulkanManager &manager = engine.manager();
 
+			vkutil::SpecializationConstants specialization{};
+			for (auto &constant : info.specializationConstants) specialization.add(constant.id, constant.value);
+
+			vkutil::ShaderReflection reflection{};
+			for (auto &m : info.modules) {
+				if (!vkutil::reflect_shader_module(m.get_data(), Atlas::atlas_to_vk_shaderstage(m.get_stage()), &reflection, &specialization)) {
+					CORE_WARN("Shader: could not reflect shader: {}", m.get_file_path());
+					return nullptr;
+				}
+			}
+
 			std::vector<VkDescriptorSetLayout> layouts;
-			for (auto &d : info.descriptors) {
-				if (!d.is_init()) {
-					CORE_WARN("Shader: descriptor was not initialized!");
-					return;
+
+			//without descriptors the set layouts come from the shader, the layout cache shares them between shaders.
+			//sets the shader skips get an empty layout so every set keeps its number in the pipeline layout
+			if (info.descriptors.empty()) {
+				uint32_t setCount = reflection.sets.empty() ? 0 : reflection.sets.rbegin()->first + 1;
+
+				for (uint32_t set = 0; set < setCount; set++) {
+					auto it = reflection.sets.find(set);
+
+					VkDescriptorSetLayoutCreateInfo layoutInfo{};
+					layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+					if (it != reflection.sets.end()) {
+						layoutInfo.bindingCount = (uint32_t)it->second.size();
+						layoutInfo.pBindings = it->second.data();
+					}
+
+					layouts.push_back(manager.get_descriptor_layout_cache().create_descriptor_layout(layoutInfo));
+				}
+			}
+			else {
+				for (auto &d : info.descriptors) {
+					if (!d.is_init()) {
+						CORE_WARN("Shader: descriptor was not initialized!");
+						return nullptr;
+					}
+
+					layouts.push_back(d.get_native_descriptor()->layout);
 				}
 
-				layouts.push_back(d.get_native_descriptor()->layout);
+				if (!check_descriptors(info.descriptors, reflection)) return nullptr;
 			}
 
-			vkutil::Shader shader{};
+			std::vector<VkPushConstantRange> pushConstants = reflection.pushConstants;
+
+			if (!info.pushConstants.empty()) {
+				pushConstants.clear();
+
+				for (auto &r : info.pushConstants) {
+					VkShaderStageFlags stages = 0;
+					for (auto &s : r.stages) stages |= Atlas::atlas_to_vk_shaderstage(s);
+
+					pushConstants.push_back({ stages, r.offset, r.size });
+				}
+			}
+
+			if (!check_push_constants(pushConstants, reflection, engine.get_gpu_properties().limits.maxPushConstantsSize)) return nullptr;
 
 			//----------------------- compute ------------------------------------
 			if (info.vertexDescription.size() == 0 && info.modules.size() == 1
 				&& info.modules.at(0).get_stage() == Atlas::ShaderStage::COMPUTE) {
 
 				auto &m = info.modules.at(0);
-
-				VkShaderStageFlagBits shaderType = Atlas::atlas_to_vk_shaderstage(Atlas::ShaderStage::COMPUTE);
 				std::vector<uint32_t> &buffer = m.get_data();
 
-				VkShaderModule module{};
-				bool success = vkutil::compile_shader_module(buffer.data(), (uint32_t)(buffer.size() * sizeof(uint32_t)),
-					&module, manager.device());
+				vkutil::PipelineKey key = vkutil::compute_pipeline_key(buffer, layouts, pushConstants, &specialization);
 
-				if (!success) {
-					CORE_WARN("Shader: error while compiling shader: {}", m.get_file_path());
-					return;
-				}
+				return engine.asset_manager().acquire_shader(manager, key, [&](vkutil::Shader *shader) {
+					VkShaderModule module{};
+					bool success = vkutil::compile_shader_module(buffer.data(), (uint32_t)(buffer.size() * sizeof(uint32_t)),
+						&module, manager.device());
+
+					if (!success) {
+						CORE_WARN("Shader: error while compiling shader: {}", m.get_file_path());
+						return false;
+					}
+
+					vkutil::create_compute_shader(manager, module, layouts, &shader->pipeline, &shader->layout, pushConstants, &specialization);
+					vkDestroyShaderModule(manager.device(), module, nullptr);
 
-				vkutil::create_compute_shader(manager, module, layouts, &shader.pipeline, &shader.layout);
-				vkDestroyShaderModule(manager.device(), module, nullptr);
+					shader->pushConstants = pushConstants;
+					shader->bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+					return true;
+				});
 			}
 			//----------------------- else ------------------------------------
 			else {
-				vkutil::VertexInputDescriptionBuilder vertexBuilder(info.vertexDescription.get_stride());
-				for (auto &pair : info.vertexDescription.get_attributes()) {
-					vertexBuilder.push_attrib(atlas_to_vk_attribute(pair.first), pair.second);
-				}
+				vkutil::VertexInputDescription vertexInputDescription = reflection.vertexInput;
 
-				vkutil::VertexInputDescription vertexInputDescription = vertexBuilder.value();
+				if (info.vertexDescription.size() != 0) {
+					vkutil::VertexInputDescriptionBuilder vertexBuilder(info.vertexDescription.get_stride());
+					for (auto &pair : info.vertexDescription.get_attributes()) {
+						vertexBuilder.push_attrib(atlas_to_vk_attribute(pair.first), pair.second);
+					}
+
+					vertexInputDescription = vertexBuilder.value();
+
+					if (!check_vertex_input(vertexInputDescription, reflection)) return nullptr;
+				}
 
 				vkutil::PipelineBuilder builder(manager);
 
@@ -65,50 +153,147 @@ namespace vkutil {
 					builder.set_descriptor_layouts(layouts);
 				}
 
+				builder.set_push_constants(pushConstants);
+				builder.set_specialization(specialization);
+				builder.set_extended_dynamic_state(engine.has_dynamic_blend());
+
 				builder.set_vertex_description(vertexInputDescription)
 					.set_color_format(engine.get_color_format())
 					.set_depth_stencil(true, true, VK_COMPARE_OP_LESS_OR_EQUAL, engine.get_depth_format());
 
-				std::vector<VkShaderModule> modules;
-
 				for (auto &m : info.modules) {
-					VkShaderStageFlagBits shaderType = Atlas::atlas_to_vk_shaderstage(m.get_stage());
+					builder.add_shader_code(m.get_data(), Atlas::atlas_to_vk_shaderstage(m.get_stage()));
+				}
 
-					std::vector<uint32_t> &buffer = m.get_data();
+				return engine.asset_manager().acquire_shader(manager, builder.key(), [&](vkutil::Shader *shader) {
+					if (!builder.build(shader)) {
+						CORE_WARN("Shader: could not create pipeline");
+						return false;
+					}
 
-					VkShaderModule module{};
-					bool success = vkutil::compile_shader_module(buffer.data(), (uint32_t)(buffer.size() * sizeof(uint32_t)),
-						&module, manager.device());
+					shader->pushConstants = pushConstants;
+					return true;
+				});
+			}
+		}
 
-					if (!success) {
-						CORE_WARN("Shader: error while compiling shader: {}", m.get_file_path());
+		static bool check_descriptors(std::vector<Atlas::Descriptor> &descriptors, const vkutil::ShaderReflection &reflection)
+		{
+			bool compatible = true;
+
+			for (auto &[set, expectedBindings] : reflection.sets) {
+				for (auto &expected : expectedBindings) {
+					if (set >= (uint32_t)descriptors.size()) {
+						CORE_WARN("Shader: set {} binding {} is used by the shader but no descriptor was given", set, expected.binding);
+						compatible = false;
 						continue;
 					}
 
-					builder.add_shader_module(module, shaderType);
-					modules.push_back(module);
+					auto &bindings = descriptors.at(set).get_native_descriptor()->bindings;
+					auto it = std::find_if(bindings.begin(), bindings.end(),
+						[&](const VkDescriptorSetLayoutBinding &b) { return b.binding == expected.binding; });
+
+					if (it == bindings.end()) {
+						CORE_WARN("Shader: set {} binding {} is used by the shader but missing in the descriptor", set, expected.binding);
+						compatible = false;
+					}
+					else if (it->descriptorType != expected.descriptorType) {
+						CORE_WARN("Shader: set {} binding {} has descriptor type {}, the shader expects {}",
+							set, expected.binding, it->descriptorType, expected.descriptorType);
+						compatible = false;
+					}
+					else if (it->descriptorCount < expected.descriptorCount) {
+						CORE_WARN("Shader: set {} binding {} has {} descriptors, the shader expects {}",
+							set, expected.binding, it->descriptorCount, expected.descriptorCount);
+						compatible = false;
+					}
+					else if ((it->stageFlags & expected.stageFlags) != expected.stageFlags) {
+						CORE_WARN("Shader: set {} binding {} is not visible to every stage that uses it", set, expected.binding);
+						compatible = false;
+					}
 				}
+			}
+
+			return compatible;
+		}
+
+		static bool check_push_constants(const std::vector<VkPushConstantRange> &ranges, const vkutil::ShaderReflection &reflection, uint32_t maxSize)
+		{
+			bool compatible = true;
+
+			VkShaderStageFlags stages = 0;
+			uint32_t begin = UINT32_MAX, end = 0;
 
-				builder.build(&shader);
-				for (auto &module : modules) vkDestroyShaderModule(manager.device(), module, nullptr);
+			for (auto &r : ranges) {
+				if (r.offset + r.size > maxSize) {
+					CORE_WARN("Shader: push constant range [{}, {}) exceeds the device limit of {} bytes", r.offset, r.offset + r.size, maxSize);
+					compatible = false;
+				}
+
+				stages |= r.stageFlags;
+				begin = std::min(begin, r.offset);
+				end = std::max(end, r.offset + r.size);
 			}
 
+			//the reflected range is merged over all stages, so only check that every stage and byte is covered by some range
+			for (auto &expected : reflection.pushConstants) {
+				if ((stages & expected.stageFlags) != expected.stageFlags) {
+					CORE_WARN("Shader: push constants are not visible to every stage that uses them");
+					compatible = false;
+				}
+
+				if (begin > expected.offset || end < expected.offset + expected.size) {
+					CORE_WARN("Shader: push constant ranges [{}, {}) do not cover [{}, {}) used by the shader",
+						begin, end, expected.offset, expected.offset + expected.size);
+					compatible = false;
+				}
+			}
 
-			m_Shader = engine.asset_manager().register_shader(shader);
+			return compatible;
 		}
 
-		~VulkanShader()
+		static bool check_vertex_input(const vkutil::VertexInputDescription &description, const vkutil::ShaderReflection &reflection)
 		{
-			if (auto shared = m_Shader.lock()) {
-				Atlas::Application::get_engine().asset_manager().deregister_shader(shared);
-				vkDestroyPipeline(Atlas::Application::get_engine().device(), shared->pipeline, nullptr);
+			bool compatible = true;
+			auto &attributes = description.attributes;
+
+			for (auto &expected : reflection.vertexInput.attributes) {
+				auto it = std::find_if(attributes.begin(), attributes.end(),
+					[&](const VkVertexInputAttributeDescription &a) { return a.location == expected.location; });
+
+				if (it == attributes.end()) {
+					CORE_WARN("Shader: vertex input at location {} is not provided by the vertex description", expected.location);
+					compatible = false;
+					continue;
+				}
+
+				if (it->format != expected.format) {
+					CORE_WARN("Shader: vertex input at location {} has format {}, the shader expects {}",
+						expected.location, it->format, expected.format);
+					compatible = false;
+				}
 			}
+
+			return compatible;
+		}
+
+		bool is_ready()
+		{
+			resolve();
+			return !m_Pending.valid();
 		}
 
 		void bind()
 		{
-			VkCommandBuffer cmd = Atlas::Application::get_engine().get_active_command_buffer();
-			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, get_native_shader()->pipeline);
+			vkutil::Shader *shader = get_native_shader();
+			if (!shader) return;
+
+			vkutil::VulkanEngine &engine = Atlas::Application::get_engine();
+			VkCommandBuffer cmd = engine.get_active_command_buffer();
+			vkCmdBindPipeline(cmd, shader->bindPoint, shader->pipeline);
+
+			//the pipeline does not carry depth / cull / topology / blend state, RenderApi can override it after binding
+			if (shader->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS) engine.reset_dynamic_state(cmd);
 
 			//for (auto &d : m_Descriptors) {
 			//	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -125,6 +310,12 @@ namespace vkutil {
 
 		vkutil::Shader *get_native_shader()
 		{
+			resolve();
+
+			if (m_Pending.valid()) {
+				return m_Fallback ? m_Fallback->get_native_shader() : nullptr;
+			}
+
 			if (auto shader = m_Shader.lock()) {
 				return shader.get();
 			}
@@ -134,7 +325,19 @@ namespace vkutil {
 		}
 
 	private:
+
+		//the worker already acquired the pipeline, only the handle is picked up here
+		void resolve()
+		{
+			if (!m_Pending.valid() || m_Pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+			m_Shader = m_Pending.get();
+			m_Fallback = nullptr;
+		}
+
 		WeakRef<vkutil::Shader> m_Shader;
+		std::future<Ref<vkutil::Shader>> m_Pending;
+		Ref<VulkanShader> m_Fallback;
 		//std::vector<Atlas::Descriptor> m_Descriptors;
 	};
 }
@@ -178,6 +381,18 @@ namespace Atlas {
 		m_Shader = make_scope<vkutil::VulkanShader>(info);
 	}
 
+	Shader Shader::create_async(ShaderCreateInfo info, Shader fallback)
+	{
+		Shader shader;
+		shader.m_Shader = make_ref<vkutil::VulkanShader>(std::move(info), fallback.m_Shader);
+		return shader;
+	}
+
+	bool Shader::is_ready()
+	{
+		return m_Shader && m_Shader->is_ready();
+	}
+
 	std::optional<Shader> Shader::compute(const char *path, bool optimize)
 	{
 		auto res = ShaderModule::load(path, ShaderStage::COMPUTE, optimize);
@@ -188,6 +403,17 @@ namespace Atlas {
 		return std::optional<Shader>(info);
 	}
 
+	std::optional<Shader> Shader::compute(const char *path, std::vector<Descriptor> descriptors, bool optimize)
+	{
+		auto res = ShaderModule::load(path, ShaderStage::COMPUTE, optimize);
+		if (!res.has_value()) return std::nullopt;
+
+		ShaderCreateInfo info{};
+		info.modules = { res.value() };
+		info.descriptors = descriptors;
+		return std::optional<Shader>(info);
+	}
+
 	vkutil::Shader *Shader::get_native_shader()
 	{
 		return m_Shader->get_native_shader();
@@ -195,14 +421,25 @@ namespace Atlas {
 
 	void Shader::bind() {
 		m_Shader->bind();
+		vkutil::count(vkutil::FrameCounter::SHADER_BINDS);
+	}
+
+	std::future<std::optional<ShaderModule>> ShaderModule::load_async(const char *path, ShaderStage stage, bool optimize,
+		const ShaderDefines &defines)
+	{
+		std::string filePath = path;
+		return Application::get_thread_pool().submit([filePath, stage, optimize, defines]() {
+			return ShaderModule::load(filePath.c_str(), stage, optimize, defines);
+		});
 	}
 
-	std::optional<ShaderModule> ShaderModule::load(const char *path, ShaderStage stage, bool optimize)
+	std::optional<ShaderModule> ShaderModule::load(const char *path, ShaderStage stage, bool optimize, const ShaderDefines &defines)
 	{
 		ShaderModule module;
 		module.m_Path = path;
 		module.m_Stage = stage;
 		module.m_Optimization = optimize;
+		module.m_Defines = defines;
 
 		auto filePath = std::filesystem::path(path);
 		auto ext = filePath.extension();
@@ -229,10 +466,88 @@ namespace Atlas {
 		}
 		else {
 			module.m_Data = make_ref<std::vector<uint32_t>>(vkutil::compile_glsl_to_spirv(path, atlas_to_vk_shaderstage(stage),
-				(char *)data.data(), fileSize, optimize));
+				(char *)data.data(), fileSize, optimize, defines));
 		}
 
 		return module;
 	}
 
+	ShaderPermutations::ShaderPermutations(ShaderPermutationInfo &info)
+		:m_Info(info)
+	{
+	}
+
+	std::optional<Shader> ShaderPermutations::get(const ShaderDefines &defines, const std::vector<SpecializationConstant> &constants)
+	{
+		//the order of defines and constants does not change the variant
+		ShaderDefines sortedDefines = defines;
+		std::sort(sortedDefines.begin(), sortedDefines.end());
+
+		std::vector<SpecializationConstant> sortedConstants = constants;
+		std::sort(sortedConstants.begin(), sortedConstants.end(),
+			[](const SpecializationConstant &a, const SpecializationConstant &b) { return a.id < b.id; });
+
+		uint64_t constantsKey = hash_mix(sortedConstants.size());
+		for (auto &c : sortedConstants) {
+			constantsKey = hash_combine(constantsKey, c.id);
+			constantsKey = hash_combine(constantsKey, c.value);
+		}
+
+		uint64_t variantKey = constantsKey;
+		for (auto &[name, value] : sortedDefines) {
+			variantKey = hash_combine(variantKey, hash_bytes(name.data(), name.size()));
+			variantKey = hash_combine(variantKey, hash_bytes(value.data(), value.size()));
+		}
+
+		auto variant = m_Variants.find(variantKey);
+		if (variant != m_Variants.end()) {
+			if (!variant->second.is_init()) return std::nullopt;
+			return variant->second;
+		}
+
+		//compile every stage of the variant in parallel
+		std::vector<std::future<std::optional<ShaderModule>>> loads;
+		for (auto &[path, stage] : m_Info.sources) {
+			loads.push_back(ShaderModule::load_async(path.c_str(), stage, m_Info.optimize, sortedDefines));
+		}
+
+		ShaderCreateInfo createInfo{};
+		createInfo.vertexDescription = m_Info.vertexDescription;
+		createInfo.descriptors = m_Info.descriptors;
+		createInfo.pushConstants = m_Info.pushConstants;
+		createInfo.specializationConstants = sortedConstants;
+
+		uint64_t pipelineKey = constantsKey;
+		bool success = true;
+
+		for (auto &load : loads) {
+			std::optional<ShaderModule> module = load.get();
+			if (!module.has_value() || module->get_data().empty()) {
+				success = false;
+				continue;
+			}
+
+			std::vector<uint32_t> &code = module->get_data();
+			pipelineKey = hash_combine(pipelineKey, (uint64_t)module->get_stage());
+			pipelineKey = hash_combine(pipelineKey, hash_bytes(code.data(), code.size() * sizeof(uint32_t)));
+
+			createInfo.modules.push_back(module.value());
+		}
+
+		if (!success) {
+			CORE_WARN("ShaderPermutations: could not compile variant");
+			m_Variants[variantKey] = Shader();
+			return std::nullopt;
+		}
+
+		//defines that do not change the generated code reuse the existing pipeline
+		auto pipeline = m_Pipelines.find(pipelineKey);
+		if (pipeline == m_Pipelines.end()) {
+			pipeline = m_Pipelines.insert({ pipelineKey, Shader(createInfo) }).first;
+		}
+
+		m_Variants[variantKey] = pipeline->second;
+		return pipeline->second;
+	}
+
 }
@@ -58,6 +58,23 @@ namespace Atlas {
 		uint32_t m_SizeOfVertex = 0;
 	};
 
+	//name, value pairs passed to the compiler as #define
+	using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+	struct SpecializationConstant {
+		uint32_t id{ 0 };
+		uint32_t value{ 0 }; //bit pattern of the constant
+
+		SpecializationConstant(uint32_t id, uint32_t value)
+			:id(id), value(value) {}
+		SpecializationConstant(uint32_t id, int32_t value)
+			:id(id), value((uint32_t)value) {}
+		SpecializationConstant(uint32_t id, bool value)
+			:id(id), value(value ? 1 : 0) {}
+		SpecializationConstant(uint32_t id, float value)
+			:id(id) { memcpy(&this->value, &value, sizeof(float)); }
+	};
+
 	class ShaderModule;
 	std::optional<ShaderModule> load(const char *path, ShaderStage stage, bool optimize = true);
 
@@ -71,7 +88,10 @@ namespace Atlas {
 		std::vector<uint32_t> &get_data() { return *m_Data.get(); }
 		const char *get_file_path() { return m_Path.c_str(); }
 
-		static std::optional<ShaderModule> load(const char *path, ShaderStage stage, bool optimize);
+		static std::optional<ShaderModule> load(const char *path, ShaderStage stage, bool optimize, const ShaderDefines &defines = {});
+		//compiles on the application thread pool
+		static std::future<std::optional<ShaderModule>> load_async(const char *path, ShaderStage stage, bool optimize,
+			const ShaderDefines &defines = {});
 
 	private:
 
@@ -79,6 +99,13 @@ namespace Atlas {
 		Ref<std::vector<uint32_t>> m_Data;
 		std::string m_Path{};
 		bool m_Optimization{ false };
+		ShaderDefines m_Defines;
+	};
+
+	struct PushConstantRange {
+		std::vector<ShaderStage> stages;
+		uint32_t offset{ 0 };
+		uint32_t size{ 0 };
 	};
 
 	struct ShaderCreateInfo {
@@ -86,6 +113,12 @@ namespace Atlas {
 		VertexDescription vertexDescription;
 
 		std::vector<Descriptor> descriptors;
+
+		//empty means a single range covering every push constant block of the shaders
+		std::vector<PushConstantRange> pushConstants;
+
+		//applied to every stage
+		std::vector<SpecializationConstant> specializationConstants;
 	};
 
 
@@ -95,13 +128,49 @@ namespace Atlas {
 		Shader() = default;
 		Shader(ShaderCreateInfo &info);
 
+		//creates the pipeline on the application thread pool, binding it uses the fallback until it is ready
+		static Shader create_async(ShaderCreateInfo info, Shader fallback = Shader());
+
 		static std::optional<Shader> compute(const char *path, bool optimize = true);
+		//push descriptors need their layout, so they have to be given instead of reflected
+		static std::optional<Shader> compute(const char *path, std::vector<Descriptor> descriptors, bool optimize = true);
 		vkutil::Shader *get_native_shader();
 
+		bool is_ready();
+		inline bool is_init() { return m_Shader != nullptr; }
+
 		void bind();
 
 	private:
 
 		Ref<vkutil::VulkanShader> m_Shader;
 	};
+
+	struct ShaderPermutationInfo {
+		std::vector<std::pair<std::string, ShaderStage>> sources; //path, stage
+		VertexDescription vertexDescription;
+		std::vector<Descriptor> descriptors;
+		std::vector<PushConstantRange> pushConstants;
+		bool optimize{ true };
+	};
+
+	//compiles a variant the first time it is requested, variants that compile to the same code share a pipeline
+	class ShaderPermutations {
+	public:
+
+		ShaderPermutations() = default;
+		ShaderPermutations(ShaderPermutationInfo &info);
+
+		std::optional<Shader> get(const ShaderDefines &defines, const std::vector<SpecializationConstant> &constants = {});
+
+		inline uint32_t get_variant_count() { return (uint32_t)m_Variants.size(); }
+		inline uint32_t get_pipeline_count() { return (uint32_t)m_Pipelines.size(); }
+
+	private:
+
+		ShaderPermutationInfo m_Info;
+
+		std::unordered_map<uint64_t, Shader> m_Variants;
+		std::unordered_map<uint64_t, Shader> m_Pipelines;
+	};
 }
@@ -4,6 +4,7 @@
 #include "atl_vk_utils.h"
 #include "vk_initializers.h"
 #include "vk_engine.h"
+#include "vk_residency.h"
 
 uint32_t to_rgb(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
 	uint32_t result = (a << 24) | (r << 16) | (g << 8) | b;
@@ -61,7 +62,7 @@ namespace Atlas {
 		return os;
 	}
 
-	Texture::Texture(const char *path, FilterOptions options)
+	Texture::Texture(const char *path, FilterOptions options, bool mipmaps)
 		: m_Initialized(true)
 	{
 		if (!std::filesystem::exists(path)) {
@@ -70,10 +71,14 @@ namespace Atlas {
 		}
 
 		VkFilter filter = atlas_to_vk_filter(options);
+		vkutil::VulkanManager &manager = Application::get_engine().manager();
+
+		//nearest filtering is used for pixel art, blurring it anisotropically defeats the point
+		float anisotropy = mipmaps && filter == VK_FILTER_LINEAR ? manager.get_max_anisotropy() : 1.0f;
 
 		vkutil::VkTexture texture;
-		VkSamplerCreateInfo info = vkinit::sampler_create_info(filter);
-		vkutil::load_texture(path, Application::get_engine().manager(), info, &texture);
+		VkSamplerCreateInfo info = vkinit::sampler_create_info(filter, VK_SAMPLER_ADDRESS_MODE_REPEAT, 0.0f, anisotropy);
+		vkutil::load_texture(path, manager, info, &texture, mipmaps);
 
 		m_Texture = Application::get_engine().asset_manager().register_texture(texture);
 	}
@@ -103,8 +108,76 @@ namespace Atlas {
 		m_Texture = Application::get_engine().asset_manager().register_texture(texture);
 	}
 
+	Ref<Texture> Texture::storage(uint32_t width, uint32_t height, FilterOptions options)
+	{
+		//storage support for the swapchain format is not guaranteed, RGBA8 is
+		vkutil::TextureCreateInfo info = vkutil::color_texture_create_info(width, height, VK_FORMAT_R8G8B8A8_UNORM);
+		info.filter = atlas_to_vk_filter(options);
+		info.usageFlags = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+		vkutil::VkTexture texture;
+		vkutil::alloc_texture(Application::get_engine().manager(), info, &texture);
+
+		Ref<Texture> result = make_ref<Texture>();
+		result->m_Texture = Application::get_engine().asset_manager().register_texture(texture);
+		result->m_Initialized = true;
+
+		return result;
+	}
+
+	Ref<Texture> Texture::load_async(const char *path, FilterOptions options, bool mipmaps)
+	{
+		Ref<Texture> result = make_ref<Texture>();
+		result->m_Initialized = true;
+
+		if (!std::filesystem::exists(path)) {
+			CORE_WARN("Could not find file: {}", path);
+		}
+
+		VkFilter filter = atlas_to_vk_filter(options);
+		vkutil::VulkanEngine &engine = Application::get_engine();
+		vkutil::VulkanManager &manager = engine.manager();
+
+		float anisotropy = mipmaps && filter == VK_FILTER_LINEAR ? manager.get_max_anisotropy() : 1.0f;
+		VkSamplerCreateInfo info = vkinit::sampler_create_info(filter, VK_SAMPLER_ADDRESS_MODE_REPEAT, 0.0f, anisotropy);
+
+		result->m_Request = engine.texture_streamer().request(path, info, mipmaps);
+		return result;
+	}
+
+	bool Texture::is_resident()
+	{
+		return poll_request() && !m_Texture.expired();
+	}
+
+	bool Texture::poll_request()
+	{
+		if (!m_Request) return true;
+		if (m_Request->state != vkutil::TextureRequest::State::Resident) return false;
+
+		m_Texture = m_Request->resident;
+		m_Residency = m_Request->residency;
+		m_Request = nullptr;
+		return true;
+	}
+
+	void Texture::mark_used(float screenSize)
+	{
+		if (!poll_request() || !m_Residency) return;
+
+		Application::get_engine().residency_manager().mark_used(*m_Residency, screenSize);
+	}
+
+	void Texture::set_memory_budget(uint64_t bytes)
+	{
+		Application::get_engine().residency_manager().set_budget(bytes);
+	}
+
 	Texture::~Texture()
 	{
+		//the streamer throws the upload away once it is done
+		if (m_Request && !poll_request()) m_Request->cancelled = true;
+
 		if (auto shared = m_Texture.lock()) {
 			Application::get_engine().asset_manager().queue_destroy_texture(shared);
 			//Application::get_engine().asset_manager().deregister_texture(shared);
@@ -117,37 +190,93 @@ namespace Atlas {
 	{
 		//m_Texture = other.m_Texture;
 		m_Texture.swap(other.m_Texture);
+		m_Request.swap(other.m_Request);
+		m_Residency.swap(other.m_Residency);
 		std::swap(m_Initialized, other.m_Initialized);
 		return *this;
 	}
 
 	uint32_t Texture::width()
 	{
-		if (auto texture = m_Texture.lock()) {
-			return texture->width;
-		}
+		//evicted mips don't change the size of the texture
+		if (poll_request() && m_Residency) return m_Residency->width;
 
-		CORE_WARN("This texture was never created / or deleted!");
-		return 0;
+		vkutil::VkTexture *texture = get_native_texture();
+		return texture ? texture->width : 0;
 	}
 
 	uint32_t Texture::height()
 	{
-		if (auto texture = m_Texture.lock()) {
-			return texture->height;
+		if (poll_request() && m_Residency) return m_Residency->height;
+
+		vkutil::VkTexture *texture = get_native_texture();
+		return texture ? texture->height : 0;
+	}
+
+	void Texture::set_render_extent(uint32_t width, uint32_t height)
+	{
+		vkutil::VkTexture *texture = get_native_texture();
+		if (!texture) return;
+
+		if (width > texture->width || height > texture->height) {
+			CORE_WARN("Texture: render extent {}x{} is larger than the {}x{} texture", width, height, texture->width, texture->height);
+			return;
 		}
 
-		CORE_WARN("This texture was never created / or deleted!");
-		return 0;
+		texture->renderExtent = { width, height };
+	}
+
+	glm::uvec2 Texture::get_render_extent()
+	{
+		vkutil::VkTexture *texture = get_native_texture();
+		if (!texture) return { 0, 0 };
+
+		if (texture->renderExtent.width == 0 || texture->renderExtent.height == 0) return { texture->width, texture->height };
+		return { texture->renderExtent.width, texture->renderExtent.height };
+	}
+
+	bool Texture::can_set_data()
+	{
+		if (!poll_request()) {
+			CORE_WARN("Texture: can not set the data of a texture that is still streaming");
+			return false;
+		}
+
+		if (m_Residency) {
+			CORE_WARN("Texture: can not set the data of a texture whose mips are managed by the residency manager");
+			return false;
+		}
+
+		auto texture = m_Texture.lock();
+		if (texture && texture->transient) {
+			CORE_WARN("Texture: can not set the data of a transient attachment");
+			return false;
+		}
+
+		return true;
 	}
 
 	void Texture::set_data(uint32_t *data, uint32_t count)
 	{
+		if (!can_set_data()) return;
+
 		if (auto texture = m_Texture.lock()) {
+			if (count != texture->width * texture->height) {
+				CORE_WARN("Texture: {} does not match width * height!", count);
+				return;
+			}
 
-			if (count != texture->width * texture->height) CORE_WARN("Texture: {} does not match width * height!", count);
+			set_data({ 0, 0, texture->width, texture->height }, data);
+		}
+	}
 
-			vkutil::set_texture_data(Application::get_engine().manager(), *texture.get(), data);
+	void Texture::set_data(const TextureRegion &region, const void *data, uint32_t rowPitch)
+	{
+		if (!can_set_data()) return;
+
+		if (auto texture = m_Texture.lock()) {
+			VkRect2D rect{ { (int32_t)region.x, (int32_t)region.y }, { region.width, region.height } };
+			Application::get_engine().upload_batch().update_texture(*texture, rect, data, rowPitch);
 		}
 	}
 
@@ -156,15 +285,33 @@ namespace Atlas {
 		set_data((uint32_t *)data, count);
 	}
 
+	std::future<std::vector<uint8_t>> Texture::read_async(const TextureRegion &region)
+	{
+		if (!poll_request()) {
+			CORE_WARN("Texture: can not read a texture that is still streaming");
+			return vkutil::ReadbackRing::empty();
+		}
+
+		auto texture = m_Texture.lock();
+		if (!texture) return vkutil::ReadbackRing::empty();
+
+		VkRect2D rect{ { (int32_t)region.x, (int32_t)region.y }, { region.width, region.height } };
+		if (region.width == 0 || region.height == 0) rect = { { 0, 0 }, { texture->width, texture->height } };
+
+		return Application::get_engine().read_texture(*texture, rect);
+	}
+
 	void *Texture::get_id()
 	{
+		if (!poll_request()) return vkutil::imgui_descriptor(Application::get_engine().texture_streamer().get_placeholder());
+
 		if (auto texture = m_Texture.lock()) {
 			if (!texture->bImguiDescriptor) {
-				CORE_WARN("no imgui descriptors were created for this texture");
+				CORE_WARN("this texture can not be shown through imgui");
 				return nullptr;
 			}
 
-			return texture->imguiDescriptor;
+			return vkutil::imgui_descriptor(*texture);
 		}
 
 		CORE_WARN("This texture was never created / or deleted!");
@@ -172,6 +319,8 @@ namespace Atlas {
 	}
 	vkutil::VkTexture *Texture::get_native_texture()
 	{
+		if (!poll_request()) return &Application::get_engine().texture_streamer().get_placeholder();
+
 		if (auto texture = m_Texture.lock()) {
 			return texture.get();
 		}
@@ -4,6 +4,8 @@
 
 namespace vkutil {
 	struct VkTexture;
+	struct TextureRequest;
+	struct ResidentTexture;
 }
 
 namespace Atlas {
@@ -43,11 +45,17 @@ namespace Atlas {
 		D32,
 	};
 
+	struct TextureRegion {
+		uint32_t x{ 0 }, y{ 0 };
+		uint32_t width{ 0 }, height{ 0 };
+	};
+
 	class Texture {
 	public:
 		Texture() = default;
 
-		Texture(const char *path, FilterOptions options = FilterOptions::LINEAR);
+		//mipmaps generates the full mip chain, linear filtering also samples it anisotropically
+		Texture(const char *path, FilterOptions options = FilterOptions::LINEAR, bool mipmaps = true);
 		Texture(uint32_t width, uint32_t height, FilterOptions options = FilterOptions::LINEAR);
 		Texture(uint32_t width, uint32_t height, TextureFormat format = TextureFormat::R8G8B8A8, FilterOptions options = FilterOptions::LINEAR);
 		Texture(const Texture &other) = delete;
@@ -55,11 +63,37 @@ namespace Atlas {
 
 		Texture &operator=(Texture other);
 
+		//RGBA8 image that compute shaders can write, it stays in the GENERAL layout and can't be rendered to
+		static Ref<Texture> storage(uint32_t width, uint32_t height, FilterOptions options = FilterOptions::LINEAR);
+		//decodes the file on the thread pool and uploads it on the transfer queue without blocking the frame.
+		//a 1x1 white placeholder is bound until the texture is resident, descriptor sets have to be updated afterwards
+		static Ref<Texture> load_async(const char *path, FilterOptions options = FilterOptions::LINEAR, bool mipmaps = true);
+
+		bool is_resident();
+		//streamed textures keep the mips screenSize (largest side in pixels) needs, unused ones lose them first
+		//when the memory budget is exceeded. Render2D marks the textures it draws
+		void mark_used(float screenSize = 0.0f);
+		//vram the streamed textures may use, 0 picks a share of the device local memory
+		static void set_memory_budget(uint64_t bytes);
+
 		uint32_t width();
 		uint32_t height();
 
+		//render passes only cover width x height from the origin, a render target can stay allocated larger while
+		//its size changes. 0 covers the whole texture
+		void set_render_extent(uint32_t width, uint32_t height);
+		glm::uvec2 get_render_extent();
+
 		void set_data(Color *data, uint32_t count);
 		void set_data(uint32_t *data, uint32_t count);
+		//updates a rectangle of the texture, the rest keeps its content. rowPitch is the distance between rows of
+		//data in bytes, 0 for tightly packed rows. the data is copied right away and the copy runs at the start of
+		//the frame's graphics work, so the call never waits on the gpu
+		void set_data(const TextureRegion &region, const void *data, uint32_t rowPitch = 0);
+
+		//copies the region (the whole texture if it is empty) of level 0 to the cpu as tightly packed rows. the copy is
+		//recorded at this point of the frame, the future resolves once the frame finished on the gpu
+		std::future<std::vector<uint8_t>> read_async(const TextureRegion &region = {});
 
 		void *get_id();
 
@@ -68,7 +102,13 @@ namespace Atlas {
 
 	private:
 
+		//moves the streamed texture over once it is resident
+		bool poll_request();
+		bool can_set_data();
+
 		WeakRef<vkutil::VkTexture> m_Texture;
+		Ref<vkutil::TextureRequest> m_Request;
+		Ref<vkutil::ResidentTexture> m_Residency;
 		bool m_Initialized{ false };
 	};
 
@@ -0,0 +1,50 @@
+#include "thread_pool.h"
+
+namespace Atlas {
+
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		//keep one core free for the main thread
+		if (threadCount == 0) {
+			uint32_t cores = std::thread::hardware_concurrency();
+			threadCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		for (uint32_t i = 0; i < threadCount; i++) {
+			m_Workers.emplace_back([this]() { worker_loop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+
+		m_Condition.notify_all();
+
+		for (auto &worker : m_Workers) worker.join();
+	}
+
+	void ThreadPool::worker_loop()
+	{
+		while (true) {
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stop || !m_Tasks.empty(); });
+
+				//finish the remaining tasks before shutting down, someone might wait on them
+				if (m_Stop && m_Tasks.empty()) return;
+
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop();
+			}
+
+			task();
+		}
+	}
+
+}
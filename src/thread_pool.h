@@ -0,0 +1,49 @@
+#pragma once
+
+#include <thread>
+#include <future>
+#include <condition_variable>
+
+namespace Atlas {
+
+	// fixed set of worker threads, tasks are started in submission order
+	class ThreadPool {
+	public:
+
+		ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		template<typename Func>
+		auto submit(Func &&func) -> std::future<decltype(func())> {
+			using ResultType = decltype(func());
+
+			auto task = make_ref<std::packaged_task<ResultType()>>(std::forward<Func>(func));
+			std::future<ResultType> future = task->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Tasks.push([task]() { (*task)(); });
+			}
+
+			m_Condition.notify_one();
+			return future;
+		}
+
+		inline uint32_t get_thread_count() const { return (uint32_t)m_Workers.size(); }
+
+	private:
+
+		void worker_loop();
+
+		std::vector<std::thread> m_Workers;
+		std::queue<std::function<void()>> m_Tasks;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stop{ false };
+	};
+
+}
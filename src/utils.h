@@ -13,6 +13,37 @@
 
 #define BIT(x) 1 << x
 
+// splitmix64 finalizer, spreads every input bit over the whole 64 bit result
+inline uint64_t hash_mix(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+	return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0) {
+	const uint8_t *bytes = (const uint8_t *)data;
+	uint64_t result = hash_combine(hash_mix(seed), size);
+
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(uint64_t));
+		result = hash_combine(result, word);
+	}
+
+	uint64_t tail = 0;
+	for (; i < size; i++) tail = (tail << 8) | bytes[i];
+
+	return hash_combine(result, tail);
+}
+
 template <typename T>
 class Result {
 	using ResultType = std::variant<T, std::string>;
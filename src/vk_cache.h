@@ -0,0 +1,96 @@
+#pragma once
+
+#include <shared_mutex>
+#include <atomic>
+
+namespace vkutil {
+
+	struct CacheStats {
+		uint64_t hits{ 0 };
+		uint64_t misses{ 0 };
+		size_t size{ 0 };
+	};
+
+	// hash map split into independently locked shards, lookups only take a shared lock
+	// so concurrent readers never block each other
+	template<typename Key, typename Value, typename Hash, size_t ShardCount = 16>
+	class ShardedCache {
+	public:
+
+		template<typename CreateFn>
+		Value get_or_create(const Key &key, CreateFn &&create) {
+			Shard &shard = get_shard(key);
+
+			{
+				std::shared_lock lock(shard.mutex);
+				auto it = shard.map.find(key);
+				if (it != shard.map.end()) {
+					m_Hits.fetch_add(1, std::memory_order_relaxed);
+					return it->second;
+				}
+			}
+
+			std::unique_lock lock(shard.mutex);
+
+			//another thread could have inserted the key while we waited for the lock
+			auto it = shard.map.find(key);
+			if (it != shard.map.end()) {
+				m_Hits.fetch_add(1, std::memory_order_relaxed);
+				return it->second;
+			}
+
+			m_Misses.fetch_add(1, std::memory_order_relaxed);
+
+			Value value = create();
+			shard.map.emplace(key, value);
+			return value;
+		}
+
+		template<typename Func>
+		void for_each(Func &&func) {
+			for (auto &shard : m_Shards) {
+				std::unique_lock lock(shard.mutex);
+				for (auto &pair : shard.map) func(pair.first, pair.second);
+			}
+		}
+
+		void clear() {
+			for (auto &shard : m_Shards) {
+				std::unique_lock lock(shard.mutex);
+				shard.map.clear();
+			}
+		}
+
+		CacheStats get_stats() const {
+			CacheStats stats{};
+			stats.hits = m_Hits.load(std::memory_order_relaxed);
+			stats.misses = m_Misses.load(std::memory_order_relaxed);
+
+			for (auto &shard : m_Shards) {
+				std::shared_lock lock(shard.mutex);
+				stats.size += shard.map.size();
+			}
+
+			return stats;
+		}
+
+	private:
+
+		struct Shard {
+			mutable std::shared_mutex mutex;
+			std::unordered_map<Key, Value, Hash> map;
+		};
+
+		Shard &get_shard(const Key &key) {
+			//the low bits pick the bucket inside the map, use the high bits for the shard
+			uint64_t h = (uint64_t)Hash()(key);
+			return m_Shards[(h >> 32) % ShardCount];
+		}
+
+		std::array<Shard, ShardCount> m_Shards;
+
+		std::atomic<uint64_t> m_Hits{ 0 };
+		std::atomic<uint64_t> m_Misses{ 0 };
+	};
+
+}
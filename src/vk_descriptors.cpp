@@ -19,7 +19,7 @@ namespace vkutil {
 		for (uint32_t i = 0; i < size; i++) {
 			VkDescriptorImageInfo info{};
 			info.sampler = texture[i].sampler;
-			info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			info.imageLayout = texture[i].layout;
 			info.imageView = texture[i].imageView;
 			descImageInfos.push_back(info);
 		}
@@ -32,118 +32,218 @@ namespace vkutil {
 		VkDescriptorImageInfo imageBufferInfo{};
 		imageBufferInfo.sampler = texture.sampler;
 		imageBufferInfo.imageView = texture.imageView;
-		imageBufferInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageBufferInfo.imageLayout = texture.layout;
 		return imageBufferInfo;
 	}
 
-	VkDescriptorPool createPool(VkDevice device, const DescriptorAllocator::PoolSizes &poolSizes, int count, VkDescriptorPoolCreateFlags flags) {
-		std::vector<VkDescriptorPoolSize> sizes;
-		sizes.reserve(poolSizes.sizes.size());
-
-		for (auto &sz : poolSizes.sizes) {
-			sizes.push_back({ sz.first, uint32_t(sz.second * count) });
-		}
-
-		VkDescriptorPoolCreateInfo poolInfo = {};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.flags = flags;
-		poolInfo.maxSets = count;
-		poolInfo.poolSizeCount = (uint32_t)sizes.size();
-		poolInfo.pPoolSizes = sizes.data();
-
-		VkDescriptorPool descriptorPool;
-		vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool);
-
-		return descriptorPool;
+	void DescriptorAllocator::init(VkDevice device) {
+		m_Device = device;
 	}
 
 	void DescriptorAllocator::reset_pools() {
-		for (auto p : m_UsedPools) {
-			vkResetDescriptorPool(m_Device, p, 0);
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto &p : m_UsedPools) {
+			//pools created before the usage was known are likely too small, let them be replaced by right-sized ones
+			if (p.maxSets < m_SetsPerPool / 4) {
+				vkDestroyDescriptorPool(m_Device, p.pool, nullptr);
+				continue;
+			}
+
+			vkResetDescriptorPool(m_Device, p.pool, 0);
+			p.allocatedSets = 0;
+			p.used.clear();
 			m_FreePools.push_back(p);
 		}
 
 		m_UsedPools.clear();
-		m_CurrentPool = VK_NULL_HANDLE;
 	}
 
 	bool DescriptorAllocator::allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout) {
+		return allocate(set, layout, {});
+	}
+
+	bool DescriptorAllocator::allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout, const std::vector<VkDescriptorSetLayoutBinding> &bindings) {
 		CORE_ASSERT(m_Device, "DescriptorAllocator is not initialized");
 
-		if (m_CurrentPool == VK_NULL_HANDLE) {
-			m_CurrentPool = grab_pool();
-			m_UsedPools.push_back(m_CurrentPool);
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		//record before allocating so a pool created for a failed allocation already fits this set
+		record_usage(bindings);
+
+		if (m_UsedPools.empty()) {
+			m_UsedPools.push_back(grab_pool());
 		}
 
 		VkDescriptorSetAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 		allocInfo.pNext = nullptr;
 		allocInfo.pSetLayouts = &layout;
-		allocInfo.descriptorPool = m_CurrentPool;
+		allocInfo.descriptorPool = m_UsedPools.back().pool;
 		allocInfo.descriptorSetCount = 1;
 
 		VkResult allocResult = vkAllocateDescriptorSets(m_Device, &allocInfo, set);
-		bool needReallocate = false;
 
 		switch (allocResult) {
 		case VK_SUCCESS:
-			return true;
+			break;
 		case VK_ERROR_FRAGMENTED_POOL:
 		case VK_ERROR_OUT_OF_POOL_MEMORY:
-			needReallocate = true;
+			m_FailedAllocations++;
+			m_UsedPools.push_back(grab_pool());
+
+			allocInfo.descriptorPool = m_UsedPools.back().pool;
+			allocResult = vkAllocateDescriptorSets(m_Device, &allocInfo, set);
 			break;
 		default:
+			break;
+		}
+
+		if (allocResult != VK_SUCCESS) {
 			CORE_WARN("ERROR: {}", allocResult);
 			CORE_WARN("Could not allocate descriptor set with layout: {}", (void *)layout);
 			return false;
 		}
 
-		if (needReallocate) {
-			m_CurrentPool = grab_pool();
-			m_UsedPools.push_back(m_CurrentPool);
+		Pool &pool = m_UsedPools.back();
+		pool.allocatedSets++;
+		for (auto &b : bindings) pool.used[b.descriptorType] += b.descriptorCount;
 
-			allocResult = vkAllocateDescriptorSets(m_Device, &allocInfo, set);
+		return true;
+	}
+
+	DescriptorPoolStats DescriptorAllocator::get_stats() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
 
-			if (allocResult == VK_SUCCESS) return true;
+		DescriptorPoolStats stats{};
+		stats.usedPools = (uint32_t)m_UsedPools.size();
+		stats.freePools = (uint32_t)m_FreePools.size();
+		stats.createdPools = m_CreatedPools;
+		stats.failedAllocations = m_FailedAllocations;
+
+		uint64_t capacity = 0;
+		uint64_t used = 0;
+
+		for (auto &p : m_UsedPools) {
+			stats.allocatedSets += p.allocatedSets;
+			for (auto &size : p.capacity) capacity += size.descriptorCount;
+			for (auto &[type, count] : p.used) used += count;
 		}
 
-		CORE_WARN("ERROR: {}", allocResult);
-		CORE_WARN("Could not allocate descriptor set with layout: {}", (void *)layout);
-		return false;
+		if (capacity > 0) stats.unusedCapacity = 1.0f - float(std::min(used, capacity)) / float(capacity);
+
+		return stats;
 	}
 
 	void DescriptorAllocator::cleanup() {
-		for (auto p : m_FreePools) {
-			vkDestroyDescriptorPool(m_Device, p, nullptr);
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto &p : m_FreePools) {
+			vkDestroyDescriptorPool(m_Device, p.pool, nullptr);
+		}
+		for (auto &p : m_UsedPools) {
+			vkDestroyDescriptorPool(m_Device, p.pool, nullptr);
+		}
+
+		m_FreePools.clear();
+		m_UsedPools.clear();
+	}
+
+	void DescriptorAllocator::record_usage(const std::vector<VkDescriptorSetLayoutBinding> &bindings) {
+		m_RequestedSets++;
+
+		//the layout alone does not tell what the set consumes
+		if (bindings.empty()) {
+			for (auto &[type, ratio] : m_DescriptorSizes.sizes) m_RequestedDescriptors[type] += ratio;
+			return;
 		}
-		for (auto p : m_UsedPools) {
-			vkDestroyDescriptorPool(m_Device, p, nullptr);
+
+		std::unordered_map<VkDescriptorType, uint32_t> perSet;
+		for (auto &b : bindings) perSet[b.descriptorType] += b.descriptorCount;
+
+		for (auto &[type, count] : perSet) {
+			m_RequestedDescriptors[type] += count;
+			m_MaxPerSet[type] = std::max(m_MaxPerSet[type], count);
 		}
 	}
 
-	VkDescriptorPool DescriptorAllocator::grab_pool() {
+	DescriptorAllocator::Pool DescriptorAllocator::grab_pool() {
 		CORE_ASSERT(m_Device, "DescriptorAllocator is not initialized");
 
 		if (m_FreePools.size() > 0) {
-			VkDescriptorPool pool = m_FreePools.back();
+			Pool pool = m_FreePools.back();
 			m_FreePools.pop_back();
 			return pool;
 		}
 		else {
-			return createPool(m_Device, m_DescriptorSizes, 1000, 0);
+			return create_pool();
 		}
 	}
 
-	void DescriptorLayoutCache::cleanup() {
-		for (auto &pair : m_LayoutCache) {
-			vkDestroyDescriptorSetLayout(m_Device, pair.second, nullptr);
+	DescriptorAllocator::Pool DescriptorAllocator::create_pool() {
+		Pool pool{};
+		pool.maxSets = m_SetsPerPool;
+
+		if (m_RequestedSets == 0) {
+			for (auto &sz : m_DescriptorSizes.sizes) {
+				pool.capacity.push_back({ sz.first, uint32_t(sz.second * pool.maxSets) });
+			}
 		}
+		else {
+			//every type keeps a share of its fallback size, so a type that was not seen yet still fits into the pool
+			std::unordered_map<VkDescriptorType, uint32_t> counts;
+			for (auto &[type, ratio] : m_DescriptorSizes.sizes) {
+				counts[type] = std::max(uint32_t(ratio * pool.maxSets / 8), 1u);
+			}
+
+			//size every type by its observed descriptors per set with some headroom,
+			//but never below what a single set of that type needs
+			for (auto &[type, total] : m_RequestedDescriptors) {
+				double perSet = total / double(m_RequestedSets);
+				uint32_t count = uint32_t(std::ceil(perSet * pool.maxSets * 1.25));
+				counts[type] = std::max({ counts[type], count, m_MaxPerSet[type] });
+			}
+
+			for (auto &[type, count] : counts) pool.capacity.push_back({ type, count });
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = 0;
+		poolInfo.maxSets = pool.maxSets;
+		poolInfo.poolSizeCount = (uint32_t)pool.capacity.size();
+		poolInfo.pPoolSizes = pool.capacity.data();
+
+		VK_CHECK(vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &pool.pool));
+
+		//every new pool is bigger than the last one, so scenes settle on a few large pools
+		m_SetsPerPool = std::min(m_SetsPerPool * 2, MAX_SETS_PER_POOL);
+		m_CreatedPools++;
+
+		return pool;
+	}
+
+	void DescriptorLayoutCache::init(VkDevice device) {
+		m_Device = device;
+	}
+
+	void DescriptorLayoutCache::cleanup() {
+		m_LayoutCache.for_each([&](const DescriptorLayoutInfo &, VkDescriptorSetLayout layout) {
+			vkDestroyDescriptorSetLayout(m_Device, layout, nullptr);
+		});
+
+		m_LayoutCache.clear();
+	}
+
+	CacheStats DescriptorLayoutCache::get_stats() const {
+		return m_LayoutCache.get_stats();
 	}
 
 	VkDescriptorSetLayout DescriptorLayoutCache::create_descriptor_layout(VkDescriptorSetLayoutCreateInfo &info) {
 		CORE_ASSERT(m_Device, "DescriptorLayoutCache is not initialized");
 
 		DescriptorLayoutInfo layoutInfo;
+		layoutInfo.flags = info.flags;
 		bool isSorted = true;
 		int lastBinding = -1;
 
@@ -165,18 +265,15 @@ namespace vkutil {
 			});
 		}
 
-		auto it = m_LayoutCache.find(layoutInfo);
-		if (it != m_LayoutCache.end()) return (*it).second;
-		else {
+		return m_LayoutCache.get_or_create(layoutInfo, [&]() {
 			VkDescriptorSetLayout layout;
-			vkCreateDescriptorSetLayout(m_Device, &info, nullptr, &layout);
-
-			m_LayoutCache[layoutInfo] = layout;
+			VK_CHECK(vkCreateDescriptorSetLayout(m_Device, &info, nullptr, &layout));
 			return layout;
-		}
+		});
 	}
 
 	bool DescriptorLayoutCache::DescriptorLayoutInfo::operator==(const DescriptorLayoutInfo &other) const {
+		if (other.flags != flags) return false;
 		if (other.bindings.size() != bindings.size()) return false;
 
 		for (int i = 0; i < bindings.size(); i++) {
@@ -190,18 +287,16 @@ namespace vkutil {
 	}
 
 	size_t DescriptorLayoutCache::DescriptorLayoutInfo::hash() const {
-		using std::size_t;
-		using std::hash;
-
-		size_t result = hash<size_t>()(bindings.size());
+		uint64_t result = hash_combine(hash_mix(flags), bindings.size());
 
 		for (const VkDescriptorSetLayoutBinding &b : bindings) {
-			size_t bindingHash = b.binding | b.descriptorType << 8 | b.descriptorCount << 16 | b.stageFlags << 24;
-
-			result ^= hash<size_t>()(bindingHash);
+			result = hash_combine(result, b.binding);
+			result = hash_combine(result, b.descriptorType);
+			result = hash_combine(result, b.descriptorCount);
+			result = hash_combine(result, b.stageFlags);
 		}
 
-		return result;
+		return (size_t)result;
 	}
 
 	DescriptorBuilder::DescriptorBuilder(VulkanManager &manager)
@@ -330,7 +425,7 @@ namespace vkutil {
 
 		*layout = m_LayoutCache->create_descriptor_layout(layoutInfo);
 
-		bool success = m_Alloc->allocate(set, *layout);
+		bool success = m_Alloc->allocate(set, *layout, m_Bindings);
 		if (!success) { return false; };
 
 		for (uint32_t i = 0; i < m_Writes.size(); i++) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "vk_types.h"
+#include "vk_cache.h"
 
 namespace vkutil {
 	class VulkanManager;
@@ -11,6 +12,18 @@ namespace vkutil {
 	struct VkDescriptor {
 		VkDescriptorSet set{ VK_NULL_HANDLE };
 		VkDescriptorSetLayout layout{ VK_NULL_HANDLE };
+		std::vector<VkDescriptorSetLayoutBinding> bindings;
+	};
+
+	struct DescriptorPoolStats {
+		uint32_t usedPools{ 0 };
+		uint32_t freePools{ 0 };
+		uint32_t createdPools{ 0 };
+		uint32_t allocatedSets{ 0 };
+		uint32_t failedAllocations{ 0 };
+		//share of the descriptor capacity of the used pools that is not handed out, sets allocated without their
+		//bindings count as empty
+		float unusedCapacity{ 0.0f };
 	};
 
 	class DescriptorAllocator {
@@ -18,9 +31,7 @@ namespace vkutil {
 
 		DescriptorAllocator() = default;
 
-		DescriptorAllocator(VkDevice device)
-			:m_Device(device) {
-		}
+		void init(VkDevice device);
 
 		struct PoolSizes {
 			std::vector<std::pair<VkDescriptorType, float>> sizes =
@@ -41,17 +52,49 @@ namespace vkutil {
 
 		void reset_pools();
 		bool allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout);
+		//the bindings let the allocator learn how many descriptors of each type a set consumes
+		bool allocate(VkDescriptorSet *set, VkDescriptorSetLayout layout, const std::vector<VkDescriptorSetLayoutBinding> &bindings);
+
+		DescriptorPoolStats get_stats();
 
 		void cleanup();
 
 		VkDevice m_Device{ VK_NULL_HANDLE };
 	private:
-		VkDescriptorPool grab_pool();
 
-		VkDescriptorPool m_CurrentPool{ VK_NULL_HANDLE };
+		static constexpr uint32_t INITIAL_SETS_PER_POOL = 64;
+		static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+		struct Pool {
+			VkDescriptorPool pool{ VK_NULL_HANDLE };
+			uint32_t maxSets{ 0 };
+			uint32_t allocatedSets{ 0 };
+			std::vector<VkDescriptorPoolSize> capacity;
+			std::unordered_map<VkDescriptorType, uint32_t> used;
+		};
+
+		Pool grab_pool();
+		Pool create_pool();
+		void record_usage(const std::vector<VkDescriptorSetLayoutBinding> &bindings);
+
+		std::mutex m_Mutex;
+
+		//the pool currently allocated from is always the last used pool
+		std::vector<Pool> m_UsedPools;
+		std::vector<Pool> m_FreePools;
+
+		//fallback ratios, used until the first set was requested. afterwards they are the baseline of every pool
+		//and the assumed consumption of sets allocated without their bindings
 		PoolSizes m_DescriptorSizes;
-		std::vector<VkDescriptorPool> m_UsedPools;
-		std::vector<VkDescriptorPool> m_FreePools;
+
+		//observed consumption over the lifetime of the allocator
+		std::unordered_map<VkDescriptorType, double> m_RequestedDescriptors;
+		std::unordered_map<VkDescriptorType, uint32_t> m_MaxPerSet;
+		uint64_t m_RequestedSets{ 0 };
+
+		uint32_t m_SetsPerPool{ INITIAL_SETS_PER_POOL };
+		uint32_t m_CreatedPools{ 0 };
+		uint32_t m_FailedAllocations{ 0 };
 	};
 
 	class DescriptorLayoutCache {
@@ -59,14 +102,15 @@ namespace vkutil {
 
 		DescriptorLayoutCache() = default;
 
-		DescriptorLayoutCache(VkDevice device)
-			: m_Device(device) {}
-
+		void init(VkDevice device);
 		void cleanup();
 
 		VkDescriptorSetLayout create_descriptor_layout(VkDescriptorSetLayoutCreateInfo &info);
 
+		CacheStats get_stats() const;
+
 		struct DescriptorLayoutInfo {
+			VkDescriptorSetLayoutCreateFlags flags{ 0 };
 			std::vector<VkDescriptorSetLayoutBinding> bindings;
 
 			bool operator==(const DescriptorLayoutInfo &other) const;
@@ -83,7 +127,7 @@ namespace vkutil {
 		};
 
 		VkDevice m_Device{ VK_NULL_HANDLE };
-		std::unordered_map<DescriptorLayoutInfo, VkDescriptorSetLayout, DescriptorLayoutHash> m_LayoutCache;
+		ShardedCache<DescriptorLayoutInfo, VkDescriptorSetLayout, DescriptorLayoutHash> m_LayoutCache;
 	};
 
 	class DescriptorBuilder {
@@ -103,6 +147,7 @@ namespace vkutil {
 		bool build(VkDescriptorSet *set);
 
 		uint32_t get_layout_count();
+		inline const std::vector<VkDescriptorSetLayoutBinding> &get_bindings() const { return m_Bindings; }
 
 	private:
 		std::vector<VkWriteDescriptorSet> m_Writes;
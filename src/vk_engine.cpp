@@ -34,6 +34,82 @@ namespace vkutil {
 		dependencyInfo.pMemoryBarriers = &barrier;
 
 		vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+		count(FrameCounter::BARRIERS);
+	}
+
+	static void shader_write_barrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+		VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		VkMemoryBarrier2 barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+
+		VkDependencyInfo dependencyInfo = {};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.memoryBarrierCount = 1;
+		dependencyInfo.pMemoryBarriers = &barrier;
+
+		vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+		count(FrameCounter::BARRIERS);
+	}
+
+	//transient attachments of a format share one block of memory. the attachment writes of the pass that used the
+	//block before have to be done before the next pass writes it again
+	static void transient_alias_barrier(VkCommandBuffer cmd)
+	{
+		const VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+			| VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+		shader_write_barrier(cmd,
+			stages, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			stages, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+	}
+
+	//one half of a queue family ownership transfer, the other queue has to record the matching barrier
+	static void queue_ownership_barrier(VkCommandBuffer cmd, const std::vector<VkBuffer> &buffers,
+		uint32_t srcFamily, uint32_t dstFamily, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+		VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess)
+	{
+		if (buffers.empty()) return;
+
+		std::vector<VkBufferMemoryBarrier2> barriers(buffers.size());
+		for (size_t i = 0; i < buffers.size(); i++) {
+			VkBufferMemoryBarrier2 &barrier = barriers[i];
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+			barrier.srcStageMask = srcStage;
+			barrier.srcAccessMask = srcAccess;
+			barrier.dstStageMask = dstStage;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = srcFamily;
+			barrier.dstQueueFamilyIndex = dstFamily;
+			barrier.buffer = buffers[i];
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+		}
+
+		VkDependencyInfo dependencyInfo = {};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.bufferMemoryBarrierCount = (uint32_t)barriers.size();
+		dependencyInfo.pBufferMemoryBarriers = barriers.data();
+
+		vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+		count(FrameCounter::BARRIERS);
+	}
+
+	//stages of the graphics queue that can consume the results of async compute work
+	static const VkPipelineStageFlags2 c_AsyncComputeConsumerStages = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT
+		| VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT
+		| VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+	//pooled render targets are only rendered to in their render extent
+	static VkExtent2D render_extent(const VkTexture &tex)
+	{
+		if (tex.renderExtent.width == 0 || tex.renderExtent.height == 0) return { tex.width, tex.height };
+		return tex.renderExtent;
 	}
 
 	VulkanEngine::VulkanEngine(Window &window)
@@ -54,6 +130,14 @@ namespace vkutil {
 
 		init_imgui(window);
 
+		m_TextureStreamer.init(m_VkManager, m_AssetManager, m_ResidencyManager, m_GraphicsQueue, m_GraphicsQueueFamily,
+			m_TransferQueue, m_TransferQueueFamily);
+		m_ResidencyManager.init(m_VkManager, m_TextureStreamer, m_GraphicsQueue, m_GraphicsQueueFamily);
+		m_UploadBatch.init(m_VkManager, m_GraphicsQueue, m_GraphicsQueueFamily);
+		m_ReadbackRing.init(m_VkManager);
+		m_GpuProfiler.init(m_VkManager, m_GraphicsQueueFamily);
+		m_FrameStatistics.init(m_VkManager, m_PipelineStatistics);
+
 		init_vp_framebuffers();
 
 		m_IsInitialized = true;
@@ -64,6 +148,12 @@ namespace vkutil {
 
 			VK_CHECK(vkDeviceWaitIdle(m_Device));
 
+			m_FrameStatistics.cleanup();
+			m_GpuProfiler.cleanup();
+			m_ReadbackRing.cleanup();
+			m_UploadBatch.cleanup();
+			m_ResidencyManager.cleanup();
+			m_TextureStreamer.cleanup();
 			m_AssetManager.cleanup(m_VkManager);
 
 			destroy_texture(m_VkManager, m_ColorTexture);
@@ -94,8 +184,25 @@ namespace vkutil {
 		VK_CHECK(vkResetFences(m_Device, 1, &m_FrameData.renderFence));
 
 		VK_CHECK(vkResetCommandBuffer(m_FrameData.renderCommandBuffer, 0));
+		VK_CHECK(vkResetCommandBuffer(m_FrameData.lateCommandBuffer, 0));
+		VK_CHECK(vkResetCommandBuffer(m_FrameData.handoffCommandBuffer, 0));
+		VK_CHECK(vkResetCommandPool(m_Device, m_FrameData.computeCommandPool, 0));
+
+		m_AsyncCompute.buffers.clear();
+		m_AsyncCompute.recording = false;
+		m_AsyncCompute.begun = false;
+		m_AsyncCompute.submitted = false;
+		m_AsyncCompute.pendingWrites = false;
+
+		m_ReadbackRing.resolve();
+
+		//updates recorded since the last frame, e.g. while loading, have to finish before their textures are destroyed
+		m_UploadBatch.reset();
+		m_UploadBatch.flush();
 
 		m_AssetManager.destroy_queued(m_VkManager);
+		m_TextureStreamer.update();
+		m_ResidencyManager.update();
 
 		VkResult res = vkAcquireNextImageKHR(m_Device, m_Swapchain, UINT64_MAX,
 			m_FrameData.presentSemaphore, nullptr,
@@ -112,35 +219,56 @@ namespace vkutil {
 			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 		VK_CHECK(vkBeginCommandBuffer(m_FrameData.renderCommandBuffer, &cmdBeginInfo));
+		m_FrameData.graphicsCommandBuffer = m_FrameData.renderCommandBuffer;
 		m_FrameData.activeCommandBuffer = m_FrameData.renderCommandBuffer;
 
+		m_GpuProfiler.begin_frame(m_FrameData.renderCommandBuffer);
+		m_FrameStatistics.begin_frame(m_FrameData.renderCommandBuffer);
 	}
 
 	void VulkanEngine::end_frame(uint32_t swapchainImageIndex)
 	{
 		ATL_EVENT();
 
-		VkCommandBuffer cmd = m_FrameData.renderCommandBuffer;
-
-		VK_CHECK(vkEndCommandBuffer(cmd));
-		m_FrameData.activeCommandBuffer = VK_NULL_HANDLE;
-
-		VkSubmitInfo submitInfo = vkinit::submit_info(&cmd);
-
-		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-
-		submitInfo.pWaitDstStageMask = &waitStage;
+		if (m_AsyncCompute.recording) {
+			CORE_WARN("VulkanEngine::end_async_compute was never called!");
+			end_async_compute();
+		}
 
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = &m_FrameData.presentSemaphore;
+		if (m_AsyncCompute.begun) sync_async_compute();
 
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = &m_FrameData.renderSemaphore;
+		VkCommandBuffer cmd = m_FrameData.graphicsCommandBuffer;
 
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &cmd;
+		m_GpuProfiler.end_frame(cmd);
+		m_FrameStatistics.end_frame(cmd);
 
-		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, m_FrameData.renderFence));
+		VK_CHECK(vkEndCommandBuffer(cmd));
+		m_FrameData.activeCommandBuffer = VK_NULL_HANDLE;
+		m_FrameData.graphicsCommandBuffer = VK_NULL_HANDLE;
+
+		//the consumer stages are sync2 flags, so the frame is submitted with vkQueueSubmit2
+		VkSemaphoreSubmitInfo waitInfos[] = {
+			vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, m_FrameData.presentSemaphore),
+			vkinit::semaphore_submit_info(c_AsyncComputeConsumerStages, m_FrameData.computeSemaphore) };
+		VkSemaphoreSubmitInfo signalInfo =
+			vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_FrameData.renderSemaphore);
+
+		//the texture updates of the frame are copied before anything reads them
+		VkCommandBuffer uploadCmd = m_UploadBatch.end();
+		bool uploads = uploadCmd != VK_NULL_HANDLE;
+		VkCommandBufferSubmitInfo cmdInfos[] = {
+			vkinit::command_buffer_submit_info(uploads ? uploadCmd : cmd), vkinit::command_buffer_submit_info(cmd) };
+
+		VkSubmitInfo2 submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+		submitInfo.waitSemaphoreInfoCount = m_AsyncCompute.submitted ? 2 : 1;
+		submitInfo.pWaitSemaphoreInfos = waitInfos;
+		submitInfo.commandBufferInfoCount = uploads ? 2 : 1;
+		submitInfo.pCommandBufferInfos = cmdInfos;
+		submitInfo.signalSemaphoreInfoCount = 1;
+		submitInfo.pSignalSemaphoreInfos = &signalInfo;
+
+		VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submitInfo, m_FrameData.renderFence));
 
 		VkPresentInfoKHR presentInfo = vkinit::present_info();
 
@@ -194,6 +322,7 @@ namespace vkutil {
 		vkCmdSetScissor(cmd, 0, 1, &scissor);
 
 		vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
+		count(FrameCounter::RENDER_PASSES);
 		func();
 		vkCmdEndRenderPass(cmd);
 	}
@@ -226,7 +355,16 @@ namespace vkutil {
 			return;
 		}
 
+		if (m_AsyncCompute.recording) {
+			CORE_WARN("VulkanEngine: can not render while recording async compute work!");
+			return;
+		}
+
 		VkCommandBuffer cmd = get_active_command_buffer();
+		flush_compute_writes(cmd);
+
+		//passes never nest, so this orders every pass after the one before it
+		if (color.transient || depth.transient) transient_alias_barrier(cmd);
 
 		VkImageSubresourceRange colorRange{};
 		colorRange.levelCount = 1;
@@ -243,13 +381,30 @@ namespace vkutil {
 			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
 			colorRange);
 
+		VkImageSubresourceRange depthRange{};
+		depthRange.levelCount = 1;
+		depthRange.layerCount = 1;
+		depthRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+		//the depth is cleared, so its old contents are discarded
+		insert_image_memory_barrier(cmd,
+			depth.imageAllocation.image,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			depthRange);
+
 		VkRenderingAttachmentInfo  colorAttachment{};
 		colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 		colorAttachment.pNext = nullptr;
 		colorAttachment.clearValue = { clearColor.r, clearColor.g, clearColor.b, clearColor.a };
 		colorAttachment.imageView = color.imageView;
 		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; //VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		//nothing can read a transient attachment after the pass, tilers then never write it to memory
+		colorAttachment.storeOp = color.transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 
 		VkRenderingAttachmentInfo  depthAttachment{};
@@ -259,13 +414,14 @@ namespace vkutil {
 		depthAttachment.imageView = depth.imageView;
 		depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL; //VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL;
 		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.storeOp = depth.transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
 
 		VkRenderingInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
 		info.pNext = nullptr;
 		info.renderArea.offset = { 0, 0 };
-		info.renderArea.extent = { color.width, color.height };
+		VkExtent2D extent = render_extent(color);
+		info.renderArea.extent = extent;
 		info.layerCount = 1;
 		info.colorAttachmentCount = 1;
 		info.pColorAttachments = &colorAttachment;
@@ -273,22 +429,24 @@ namespace vkutil {
 
 		VkViewport viewport{};
 		viewport.x = 0;
-		viewport.y = (float)color.height;
-		viewport.height = -(float)color.height;
-		viewport.width = (float)color.width;
+		viewport.y = (float)extent.height;
+		viewport.height = -(float)extent.height;
+		viewport.width = (float)extent.width;
 		viewport.minDepth = 0;
 		viewport.maxDepth = 1;
 
 		VkRect2D scissor{};
 		scissor.offset = { 0, 0 };
-		scissor.extent = { color.width, color.height };
+		scissor.extent = extent;
 
 		vkCmdSetViewport(cmd, 0, 1, &viewport);
 		vkCmdSetScissor(cmd, 0, 1, &scissor);
 
 		vkCmdBeginRendering(cmd, &info);
+		count(FrameCounter::RENDER_PASSES);
 
 		m_DynRenderpassInfo.boundImage = color.imageAllocation.image;
+		m_DynRenderpassInfo.transient = color.transient;
 		m_DynRenderpassInfo.active = true;
 	}
 
@@ -299,9 +457,24 @@ namespace vkutil {
 			return;
 		}
 
+		if (m_AsyncCompute.recording) {
+			CORE_WARN("VulkanEngine: can not render while recording async compute work!");
+			return;
+		}
+
 		//TODO: check alpha blending mode (not rendered to it if transparent)
 
 		VkCommandBuffer cmd = get_active_command_buffer();
+		flush_compute_writes(cmd);
+
+		//a transient color keeps nothing from an earlier pass, it is always cleared
+		bool load = clearColor.a == 0;
+		if (color.transient) {
+			if (load) CORE_WARN("VulkanEngine: transient attachments can not be loaded, the color is cleared");
+			load = false;
+			transient_alias_barrier(cmd);
+		}
+
 		VkImageSubresourceRange colorRange{};
 		colorRange.levelCount = 1;
 		colorRange.layerCount = 1;
@@ -312,7 +485,7 @@ namespace vkutil {
 			0,
 			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
 			//VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			color.transient ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
 			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
 			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
@@ -324,37 +497,40 @@ namespace vkutil {
 		colorAttachment.clearValue = { clearColor.r, clearColor.g, clearColor.b, clearColor.a };
 		colorAttachment.imageView = color.imageView;
 		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; //VK_IMAGE_LAYOUT_ATTACHMENT_OPTIMAL;
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		colorAttachment.loadOp = clearColor.a == 0 ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = color.transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.loadOp = load ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
 
 
 		VkRenderingInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
 		info.pNext = nullptr;
 		info.renderArea.offset = { 0, 0 };
-		info.renderArea.extent = { color.width, color.height };
+		VkExtent2D extent = render_extent(color);
+		info.renderArea.extent = extent;
 		info.layerCount = 1;
 		info.colorAttachmentCount = 1;
 		info.pColorAttachments = &colorAttachment;
 
 		VkViewport viewport{};
 		viewport.x = 0;
-		viewport.y = (float)color.height;
-		viewport.height = -(float)color.height;
-		viewport.width = (float)color.width;
+		viewport.y = (float)extent.height;
+		viewport.height = -(float)extent.height;
+		viewport.width = (float)extent.width;
 		viewport.minDepth = 0;
 		viewport.maxDepth = 1;
 
 		VkRect2D scissor{};
 		scissor.offset = { 0, 0 };
-		scissor.extent = { color.width, color.height };
+		scissor.extent = extent;
 
 		vkCmdSetViewport(cmd, 0, 1, &viewport);
 		vkCmdSetScissor(cmd, 0, 1, &scissor);
 
 		vkCmdBeginRendering(cmd, &info);
+		count(FrameCounter::RENDER_PASSES);
 
 		m_DynRenderpassInfo.boundImage = color.imageAllocation.image;
+		m_DynRenderpassInfo.transient = color.transient;
 		m_DynRenderpassInfo.active = true;
 	}
 
@@ -374,7 +550,8 @@ namespace vkutil {
 		colorRange.layerCount = 1;
 		colorRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
-		insert_image_memory_barrier(cmd,
+		//transient colors can not be sampled, they stay an attachment
+		if (!m_DynRenderpassInfo.transient) insert_image_memory_barrier(cmd,
 			m_DynRenderpassInfo.boundImage,
 			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
 			VK_ACCESS_SHADER_READ_BIT,
@@ -397,7 +574,266 @@ namespace vkutil {
 		//);
 
 		m_DynRenderpassInfo.boundImage = VK_NULL_HANDLE;
+		m_DynRenderpassInfo.transient = false;
 		m_DynRenderpassInfo.active = false;
+		m_PendingGraphicsWrites = true;
+	}
+
+	void VulkanEngine::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+	{
+		VkCommandBuffer cmd = get_active_command_buffer();
+		if (!prepare_dispatch(cmd)) return;
+
+		vkCmdDispatch(cmd, groupCountX, groupCountY, groupCountZ);
+		pending_compute_writes() = true;
+		count(FrameCounter::DISPATCHES);
+	}
+
+	void VulkanEngine::dispatch_indirect(VkBuffer buffer, VkDeviceSize offset)
+	{
+		VkCommandBuffer cmd = get_active_command_buffer();
+		if (!prepare_dispatch(cmd)) return;
+
+		vkCmdDispatchIndirect(cmd, buffer, offset);
+		pending_compute_writes() = true;
+		count(FrameCounter::DISPATCHES);
+	}
+
+	uint32_t VulkanEngine::begin_gpu_scope(const char *name)
+	{
+		//async compute dispatches go into another command buffer, the scope would not cover them
+		if (m_FrameData.graphicsCommandBuffer == VK_NULL_HANDLE || m_AsyncCompute.recording) return UINT32_MAX;
+
+		return m_GpuProfiler.begin_scope(m_FrameData.graphicsCommandBuffer, name);
+	}
+
+	void VulkanEngine::end_gpu_scope(uint32_t scope)
+	{
+		if (m_FrameData.graphicsCommandBuffer == VK_NULL_HANDLE) return;
+
+		m_GpuProfiler.end_scope(m_FrameData.graphicsCommandBuffer, scope);
+	}
+
+	std::future<ReadbackData> VulkanEngine::read_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (!prepare_readback(buffer)) return ReadbackRing::empty();
+
+		return m_ReadbackRing.read_buffer(m_FrameData.graphicsCommandBuffer, buffer, offset, size);
+	}
+
+	std::future<ReadbackData> VulkanEngine::read_texture(VkTexture &tex, const VkRect2D &region)
+	{
+		if (!prepare_readback()) return ReadbackRing::empty();
+
+		return m_ReadbackRing.read_texture(m_FrameData.graphicsCommandBuffer, tex, region);
+	}
+
+	bool VulkanEngine::prepare_readback(VkBuffer buffer)
+	{
+		if (m_FrameData.graphicsCommandBuffer == VK_NULL_HANDLE) {
+			CORE_WARN("VulkanEngine: read backs can only be recorded during a frame!");
+			return false;
+		}
+
+		if (m_DynRenderpassInfo.active) {
+			CORE_WARN("VulkanEngine: can not read back inside a render pass!");
+			return false;
+		}
+
+		//the buffers of the async compute work belong to the compute queue from begin_async_compute until it is synced,
+		//whether or not it is still being recorded
+		auto &owned = m_AsyncCompute.buffers;
+		if (!m_AsyncCompute.submitted && std::find(owned.begin(), owned.end(), buffer) != owned.end()) {
+			CORE_WARN("VulkanEngine: can not read back a buffer owned by async compute before sync_async_compute!");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool VulkanEngine::prepare_dispatch(VkCommandBuffer cmd)
+	{
+		//the async compute command buffer is separate, so it can be recorded while a render pass is active
+		if (m_DynRenderpassInfo.active && !m_AsyncCompute.recording) {
+			CORE_WARN("VulkanEngine: can not dispatch inside a render pass!");
+			return false;
+		}
+
+		VkPipelineStageFlags2 srcStage = 0;
+		VkAccessFlags2 srcAccess = 0;
+
+		//a dispatch usually reads what the previous one wrote, the arguments of an indirect dispatch included
+		if (pending_compute_writes()) {
+			srcStage |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			srcAccess |= VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		}
+
+		//graphics writes reach the compute queue through the semaphores and ownership transfers
+		if (m_PendingGraphicsWrites && !m_AsyncCompute.recording) {
+			srcStage |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT
+				| VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			srcAccess |= VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+				| VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		}
+
+		if (srcStage != 0) {
+			shader_write_barrier(cmd, srcStage, srcAccess,
+				VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+				VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+		}
+
+		pending_compute_writes() = false;
+		if (!m_AsyncCompute.recording) m_PendingGraphicsWrites = false;
+		return true;
+	}
+
+	bool &VulkanEngine::pending_compute_writes()
+	{
+		return m_AsyncCompute.recording ? m_AsyncCompute.pendingWrites : m_PendingComputeWrites;
+	}
+
+	void VulkanEngine::begin_async_compute(const std::vector<VkBuffer> &buffers)
+	{
+		if (!has_async_compute()) return;
+
+		if (m_AsyncCompute.recording) {
+			CORE_WARN("VulkanEngine::begin_async_compute was already called!");
+			return;
+		}
+
+		if (m_AsyncCompute.submitted) {
+			CORE_WARN("VulkanEngine: the async compute work of this frame was already submitted, recording it inline");
+			return;
+		}
+
+		VkCommandBuffer cmd = m_FrameData.computeCommandBuffer;
+
+		if (!m_AsyncCompute.begun) {
+			VkCommandBufferBeginInfo cmdBeginInfo = vkinit::command_buffer_begin_info(
+				VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+			VK_CHECK(vkBeginCommandBuffer(cmd, &cmdBeginInfo));
+			m_AsyncCompute.begun = true;
+		}
+
+		std::vector<VkBuffer> acquired;
+		for (VkBuffer buffer : buffers) {
+			auto &owned = m_AsyncCompute.buffers;
+			if (std::find(owned.begin(), owned.end(), buffer) != owned.end()) continue;
+
+			owned.push_back(buffer);
+			acquired.push_back(buffer);
+		}
+
+		//acquire, the release is recorded into the handoff command buffer on submission
+		queue_ownership_barrier(cmd, acquired, m_GraphicsQueueFamily, m_ComputeQueueFamily,
+			VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE,
+			VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+			VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+
+		m_AsyncCompute.recording = true;
+		m_FrameData.activeCommandBuffer = cmd;
+	}
+
+	void VulkanEngine::end_async_compute()
+	{
+		if (!m_AsyncCompute.recording) return;
+
+		m_AsyncCompute.recording = false;
+		m_FrameData.activeCommandBuffer = m_FrameData.graphicsCommandBuffer;
+	}
+
+	void VulkanEngine::sync_async_compute()
+	{
+		if (!m_AsyncCompute.begun || m_AsyncCompute.submitted) return;
+
+		if (m_DynRenderpassInfo.active) {
+			CORE_WARN("VulkanEngine: can not sync async compute inside a render pass!");
+			return;
+		}
+
+		if (m_AsyncCompute.recording) end_async_compute();
+
+		ATL_EVENT();
+
+		const std::vector<VkBuffer> &buffers = m_AsyncCompute.buffers;
+
+		VkCommandBuffer computeCmd = m_FrameData.computeCommandBuffer;
+		queue_ownership_barrier(computeCmd, buffers, m_ComputeQueueFamily, m_GraphicsQueueFamily,
+			VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_WRITE_BIT,
+			VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
+		VK_CHECK(vkEndCommandBuffer(computeCmd));
+
+		VkCommandBufferBeginInfo cmdBeginInfo = vkinit::command_buffer_begin_info(
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		//the release only has to wait for the previous frame, which the render fence already covers
+		VkCommandBuffer handoffCmd = m_FrameData.handoffCommandBuffer;
+		VK_CHECK(vkBeginCommandBuffer(handoffCmd, &cmdBeginInfo));
+		queue_ownership_barrier(handoffCmd, buffers, m_GraphicsQueueFamily, m_ComputeQueueFamily,
+			VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT,
+			VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
+		VK_CHECK(vkEndCommandBuffer(handoffCmd));
+
+		VkCommandBuffer earlyCmd = m_FrameData.graphicsCommandBuffer;
+		m_FrameStatistics.suspend(earlyCmd);
+		VK_CHECK(vkEndCommandBuffer(earlyCmd));
+
+		//texture updates recorded so far run first
+		VkCommandBuffer earlyCmds[2] = { m_UploadBatch.end(), earlyCmd };
+		bool uploads = earlyCmds[0] != VK_NULL_HANDLE;
+
+		//the graphics work recorded so far runs in parallel to the compute work
+		VkSubmitInfo graphicsSubmits[2] = { vkinit::submit_info(&handoffCmd), vkinit::submit_info(&earlyCmd) };
+		graphicsSubmits[0].signalSemaphoreCount = 1;
+		graphicsSubmits[0].pSignalSemaphores = &m_FrameData.handoffSemaphore;
+		graphicsSubmits[1].commandBufferCount = uploads ? 2 : 1;
+		graphicsSubmits[1].pCommandBuffers = uploads ? earlyCmds : &earlyCmd;
+
+		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 2, graphicsSubmits, VK_NULL_HANDLE));
+
+		VkPipelineStageFlags computeWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		VkSubmitInfo computeSubmit = vkinit::submit_info(&computeCmd);
+		computeSubmit.waitSemaphoreCount = 1;
+		computeSubmit.pWaitSemaphores = &m_FrameData.handoffSemaphore;
+		computeSubmit.pWaitDstStageMask = &computeWaitStage;
+		computeSubmit.signalSemaphoreCount = 1;
+		computeSubmit.pSignalSemaphores = &m_FrameData.computeSemaphore;
+
+		VK_CHECK(vkQueueSubmit(m_ComputeQueue, 1, &computeSubmit, VK_NULL_HANDLE));
+
+		//everything from here on is submitted by end_frame, after waiting for the compute semaphore
+		VkCommandBuffer lateCmd = m_FrameData.lateCommandBuffer;
+		VK_CHECK(vkBeginCommandBuffer(lateCmd, &cmdBeginInfo));
+		queue_ownership_barrier(lateCmd, buffers, m_ComputeQueueFamily, m_GraphicsQueueFamily,
+			c_AsyncComputeConsumerStages, VK_ACCESS_2_NONE,
+			c_AsyncComputeConsumerStages,
+			VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT
+			| VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT);
+		m_FrameStatistics.resume(lateCmd);
+
+		m_FrameData.graphicsCommandBuffer = lateCmd;
+		m_FrameData.activeCommandBuffer = lateCmd;
+		m_AsyncCompute.submitted = true;
+	}
+
+	bool VulkanEngine::has_async_compute()
+	{
+		return m_ComputeQueueFamily != m_GraphicsQueueFamily;
+	}
+
+	void VulkanEngine::flush_compute_writes(VkCommandBuffer cmd)
+	{
+		if (!m_PendingComputeWrites) return;
+
+		shader_write_barrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+			VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT
+			| VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT
+			| VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT);
+
+		m_PendingComputeWrites = false;
 	}
 
 	VkBool32 spdlog_debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT msgSeverity,
@@ -456,6 +892,9 @@ namespace vkutil {
 			.set_surface(m_Surface)
 			.set_required_features_13(features)
 			.add_required_extensions({ VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME })
+			//optional, enabled only if the device has them
+			.add_desired_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)
+			.add_desired_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
 			.select();
 
 		CORE_ASSERT(selection.has_value(), "could not select a suitable Physical Device. Error: {}", selection.error().message());
@@ -464,35 +903,126 @@ namespace vkutil {
 
 		CORE_TRACE("PhysicalDevice: {}", physicalDevice.name);
 
+		//the desired extensions the device supports are part of the selected extensions
+		std::vector<std::string> extensions = physicalDevice.get_extensions();
+		auto has_extension = [&](const char *name) {
+			return std::find(extensions.begin(), extensions.end(), name) != extensions.end();
+		};
+
+		//extended dynamic state 1 and 2 are core in 1.3, dynamic blending needs the optional third extension
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT supportedDynamicState3{};
+		supportedDynamicState3.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &supportedDynamicState3;
+		vkGetPhysicalDeviceFeatures2(physicalDevice.physical_device, &features2);
+
+		m_DynamicBlend = supportedDynamicState3.extendedDynamicState3ColorBlendEnable
+			&& supportedDynamicState3.extendedDynamicState3ColorBlendEquation
+			&& has_extension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+		CORE_TRACE("Dynamic blend state: {}", m_DynamicBlend);
+		if (!m_DynamicBlend) CORE_WARN("VulkanEngine: dynamic blending is not supported by this device, RenderApi::set_blend_mode is ignored");
+
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features{};
+		dynamicState3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+		dynamicState3Features.pNext = nullptr;
+		dynamicState3Features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+		dynamicState3Features.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+
 		VkPhysicalDeviceShaderDrawParametersFeatures shaderDrawParametersFeatures{};
 		shaderDrawParametersFeatures.sType =
 			VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETERS_FEATURES;
 		shaderDrawParametersFeatures.pNext = nullptr;
 		shaderDrawParametersFeatures.shaderDrawParameters = VK_TRUE;
-		vkb::Device vkbDevice = vkb::DeviceBuilder(physicalDevice)
-			.add_pNext(&shaderDrawParametersFeatures)
-			.build()
-			.value();
+
+		//the optional core features the device supports. vk-bootstrap ignores the required 1.3 features once a
+		//VkPhysicalDeviceFeatures2 is in the pNext chain, so they are chained again below
+		VkPhysicalDeviceFeatures2 enabledFeatures{};
+		enabledFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+		//anisotropic filtering is optional, samplers fall back to plain trilinear filtering
+		bool anisotropy = features2.features.samplerAnisotropy;
+		enabledFeatures.features.samplerAnisotropy = features2.features.samplerAnisotropy;
+
+		//block compressed ktx2 textures are only loaded when the device can sample their format
+		enabledFeatures.features.textureCompressionBC = features2.features.textureCompressionBC;
+		enabledFeatures.features.textureCompressionETC2 = features2.features.textureCompressionETC2;
+
+		//vertex / fragment invocation counts in the Metrics window, only the call counters without it
+		m_PipelineStatistics = features2.features.pipelineStatisticsQuery;
+		enabledFeatures.features.pipelineStatisticsQuery = features2.features.pipelineStatisticsQuery;
+
+		//lets vma report the real heap budgets to the residency manager instead of estimating them
+		bool memoryBudget = has_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		vkb::DeviceBuilder deviceBuilder(physicalDevice);
+		deviceBuilder.add_pNext(&enabledFeatures);
+		deviceBuilder.add_pNext(&features);
+		deviceBuilder.add_pNext(&shaderDrawParametersFeatures);
+		if (m_DynamicBlend) deviceBuilder.add_pNext(&dynamicState3Features);
+
+		vkb::Device vkbDevice = deviceBuilder.build().value();
 
 		m_GPUProperties = vkbDevice.physical_device.properties;
 
+		VkPhysicalDevicePushDescriptorPropertiesKHR pushDescriptorProperties{};
+		pushDescriptorProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
+
+		VkPhysicalDeviceProperties2 properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &pushDescriptorProperties;
+		vkGetPhysicalDeviceProperties2(physicalDevice.physical_device, &properties2);
+
+		m_MaxPushDescriptors = pushDescriptorProperties.maxPushDescriptors;
+
 		m_Device = vkbDevice.device;
 		m_PhysicalDevice = physicalDevice.physical_device;
 
 		m_GraphicsQueue = vkbDevice.get_queue(vkb::QueueType::graphics).value();
 		m_GraphicsQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
 
+		//prefer a family without graphics so the work can overlap with rendering, otherwise share the graphics queue
+		auto find_queue = [&](vkb::QueueType type, VkQueue *queue, uint32_t *family) {
+			auto index = vkbDevice.get_dedicated_queue_index(type);
+			if (!index.has_value()) index = vkbDevice.get_queue_index(type);
+
+			if (index.has_value() && index.value() != m_GraphicsQueueFamily) {
+				*family = index.value();
+				vkGetDeviceQueue(vkbDevice.device, *family, 0, queue);
+			}
+			else {
+				*family = m_GraphicsQueueFamily;
+				*queue = m_GraphicsQueue;
+			}
+		};
+
+		find_queue(vkb::QueueType::compute, &m_ComputeQueue, &m_ComputeQueueFamily);
+		find_queue(vkb::QueueType::transfer, &m_TransferQueue, &m_TransferQueueFamily);
+
+		CORE_TRACE("Queue families: graphics {}, compute {}, transfer {}",
+			m_GraphicsQueueFamily, m_ComputeQueueFamily, m_TransferQueueFamily);
+
 		VmaAllocatorCreateInfo allocatorInfo{};
 		allocatorInfo.physicalDevice = m_PhysicalDevice;
 		allocatorInfo.device = m_Device;
 		allocatorInfo.instance = m_Instance;
-		allocatorInfo.flags = VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT;
+		allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+		allocatorInfo.flags = memoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0;
 		vmaCreateAllocator(&allocatorInfo, &m_Allocator);
 
 		m_VkManager.init(m_Device, m_Allocator);
+		m_VkManager.init_physical_device(m_PhysicalDevice, anisotropy ? m_GPUProperties.limits.maxSamplerAnisotropy : 1.0f);
+		m_VkManager.init_pipeline_cache(m_GPUProperties, "cache/pipeline_cache.bin");
 
 		vkCmdPushDescriptorSetKHR = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(m_Device, "vkCmdPushDescriptorSetKHR");
 
+		if (m_DynamicBlend) {
+			vkCmdSetColorBlendEnableEXT = (PFN_vkCmdSetColorBlendEnableEXT)vkGetDeviceProcAddr(m_Device, "vkCmdSetColorBlendEnableEXT");
+			vkCmdSetColorBlendEquationEXT = (PFN_vkCmdSetColorBlendEquationEXT)vkGetDeviceProcAddr(m_Device, "vkCmdSetColorBlendEquationEXT");
+		}
+
 		VkPhysicalDeviceMemoryProperties prop{};
 		vkGetPhysicalDeviceMemoryProperties(m_PhysicalDevice, &prop);
 
@@ -567,12 +1097,33 @@ namespace vkutil {
 
 			VK_CHECK(vkAllocateCommandBuffers(m_Device, &cmdAllocInfo,
 				&m_FrameData.renderCommandBuffer));
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &cmdAllocInfo,
+				&m_FrameData.lateCommandBuffer));
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &cmdAllocInfo,
+				&m_FrameData.handoffCommandBuffer));
 
 			m_MainDeletionQueue.push_function([=]() {
 				vkDestroyCommandPool(m_Device, m_FrameData.commandPool, nullptr);
 			});
 		}
 
+		{
+			VkCommandPoolCreateInfo cmdPoolInfo = vkinit::command_pool_create_info(m_ComputeQueueFamily);
+
+			VK_CHECK(vkCreateCommandPool(m_Device, &cmdPoolInfo, nullptr,
+				&m_FrameData.computeCommandPool));
+
+			VkCommandBufferAllocateInfo cmdAllocInfo =
+				vkinit::command_buffer_allocate_info(m_FrameData.computeCommandPool, 1);
+
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &cmdAllocInfo,
+				&m_FrameData.computeCommandBuffer));
+
+			m_MainDeletionQueue.push_function([=]() {
+				vkDestroyCommandPool(m_Device, m_FrameData.computeCommandPool, nullptr);
+			});
+		}
+
 		m_VkManager.init_commands(m_GraphicsQueue, m_GraphicsQueueFamily);
 	}
 
@@ -682,9 +1233,16 @@ namespace vkutil {
 		VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr,
 			&m_FrameData.renderSemaphore));
 
+		VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr,
+			&m_FrameData.handoffSemaphore));
+		VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreCreateInfo, nullptr,
+			&m_FrameData.computeSemaphore));
+
 		m_MainDeletionQueue.push_function([=]() {
 			vkDestroySemaphore(m_Device, m_FrameData.presentSemaphore, nullptr);
 		vkDestroySemaphore(m_Device, m_FrameData.renderSemaphore, nullptr);
+		vkDestroySemaphore(m_Device, m_FrameData.handoffSemaphore, nullptr);
+		vkDestroySemaphore(m_Device, m_FrameData.computeSemaphore, nullptr);
 		});
 	}
 
@@ -812,6 +1370,31 @@ namespace vkutil {
 		return m_AssetManager;
 	}
 
+	TextureStreamer &VulkanEngine::texture_streamer()
+	{
+		return m_TextureStreamer;
+	}
+
+	ResidencyManager &VulkanEngine::residency_manager()
+	{
+		return m_ResidencyManager;
+	}
+
+	UploadBatch &VulkanEngine::upload_batch()
+	{
+		return m_UploadBatch;
+	}
+
+	GpuProfiler &VulkanEngine::gpu_profiler()
+	{
+		return m_GpuProfiler;
+	}
+
+	FrameStatistics &VulkanEngine::frame_statistics()
+	{
+		return m_FrameStatistics;
+	}
+
 	VkFormat VulkanEngine::get_color_format()
 	{
 		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
@@ -836,6 +1419,51 @@ namespace vkutil {
 		return m_PhysicalDevice;
 	}
 
+	const VkPhysicalDeviceProperties &VulkanEngine::get_gpu_properties()
+	{
+		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
+		return m_GPUProperties;
+	}
+
+	uint32_t VulkanEngine::get_max_push_descriptors()
+	{
+		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
+		return m_MaxPushDescriptors;
+	}
+
+	bool VulkanEngine::has_dynamic_blend()
+	{
+		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
+		return m_DynamicBlend;
+	}
+
+	void VulkanEngine::reset_dynamic_state(VkCommandBuffer cmd)
+	{
+		vkCmdSetCullMode(cmd, VK_CULL_MODE_NONE);
+		vkCmdSetFrontFace(cmd, VK_FRONT_FACE_CLOCKWISE);
+		vkCmdSetPrimitiveTopology(cmd, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+		vkCmdSetPrimitiveRestartEnable(cmd, VK_FALSE);
+
+		vkCmdSetDepthTestEnable(cmd, VK_TRUE);
+		vkCmdSetDepthWriteEnable(cmd, VK_TRUE);
+		vkCmdSetDepthCompareOp(cmd, VK_COMPARE_OP_LESS_OR_EQUAL);
+
+		if (m_DynamicBlend) {
+			VkPipelineColorBlendAttachmentState blend = vkinit::color_blend_attachment_state();
+
+			VkColorBlendEquationEXT equation{};
+			equation.srcColorBlendFactor = blend.srcColorBlendFactor;
+			equation.dstColorBlendFactor = blend.dstColorBlendFactor;
+			equation.colorBlendOp = blend.colorBlendOp;
+			equation.srcAlphaBlendFactor = blend.srcAlphaBlendFactor;
+			equation.dstAlphaBlendFactor = blend.dstAlphaBlendFactor;
+			equation.alphaBlendOp = blend.alphaBlendOp;
+
+			vkCmdSetColorBlendEnableEXT(cmd, 0, 1, &blend.blendEnable);
+			vkCmdSetColorBlendEquationEXT(cmd, 0, 1, &equation);
+		}
+	}
+
 	VkQueue VulkanEngine::get_graphics_queue()
 	{
 		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
@@ -847,6 +1475,28 @@ namespace vkutil {
 		return m_GraphicsQueueFamily;
 	}
 
+	VkQueue VulkanEngine::get_compute_queue()
+	{
+		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
+		return m_ComputeQueue;
+	}
+
+	uint32_t VulkanEngine::get_compute_queue_family()
+	{
+		return m_ComputeQueueFamily;
+	}
+
+	VkQueue VulkanEngine::get_transfer_queue()
+	{
+		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
+		return m_TransferQueue;
+	}
+
+	uint32_t VulkanEngine::get_transfer_queue_family()
+	{
+		return m_TransferQueueFamily;
+	}
+
 	VkRenderPass VulkanEngine::get_swapchain_renderpass()
 	{
 		CORE_ASSERT(m_IsInitialized, "Vulkan engine is not initialized");
@@ -884,6 +1534,7 @@ namespace vkutil {
 		barrier.dstAccessMask = dstAccessBit;
 
 		vkCmdPipelineBarrier(cmd, srcStageBit, dstStageBit, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		count(FrameCounter::BARRIERS);
 	}
 
 }
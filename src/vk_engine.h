@@ -3,6 +3,12 @@
 #include "vk_types.h"
 #include "vk_descriptors.h"
 #include "vk_manager.h"
+#include "vk_texture_streamer.h"
+#include "vk_residency.h"
+#include "vk_upload_batch.h"
+#include "vk_readback.h"
+#include "vk_profiler.h"
+#include "vk_statistics.h"
 #include "event.h"
 
 #include <glm/glm.hpp>
@@ -31,7 +37,17 @@ namespace vkutil {
 
 		VkCommandPool commandPool;
 		VkCommandBuffer renderCommandBuffer;
+		//graphics work recorded after sync_async_compute, waits for the compute queue
+		VkCommandBuffer lateCommandBuffer;
+		//releases the buffers of the async compute work to the compute queue
+		VkCommandBuffer handoffCommandBuffer;
 
+		VkCommandPool computeCommandPool;
+		VkCommandBuffer computeCommandBuffer;
+		VkSemaphore handoffSemaphore, computeSemaphore;
+
+		//the graphics command buffer that is being recorded, render or late
+		VkCommandBuffer graphicsCommandBuffer{ VK_NULL_HANDLE };
 		VkCommandBuffer activeCommandBuffer{ VK_NULL_HANDLE };
 
 		AllocatedBuffer cameraBuffer;
@@ -43,9 +59,18 @@ namespace vkutil {
 
 	struct DynRenderpassInfo {
 		VkImage boundImage{ VK_NULL_HANDLE };
+		bool transient{ false }; //the bound color is transient
 		bool active{ false };
 	};
 
+	struct AsyncComputeInfo {
+		std::vector<VkBuffer> buffers; //owned by the compute queue until the work is submitted
+		bool recording{ false };
+		bool begun{ false };
+		bool submitted{ false };
+		bool pendingWrites{ false };
+	};
+
 	class  VulkanEngine {
 	public:
 		float m_RenderResolution = 1.0f;
@@ -72,25 +97,67 @@ namespace vkutil {
 		void begin_renderpass(VkTexture &color, glm::vec4 clearColor);
 		void end_renderpass();
 
+		//has to be recorded outside of a render pass, barriers against earlier compute / rendering are inserted automatically
+		void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+		void dispatch_indirect(VkBuffer buffer, VkDeviceSize offset);
+
+		//dispatches between begin / end are recorded for the compute queue, without a separate compute queue they stay inline
+		//the buffers the dispatches access change queue family ownership, graphics may only use them after sync_async_compute
+		void begin_async_compute(const std::vector<VkBuffer> &buffers);
+		void end_async_compute();
+		//submits the async compute work together with the graphics work recorded so far, everything recorded
+		//afterwards waits for the compute queue. has to be called outside of a render pass
+		void sync_async_compute();
+		bool has_async_compute();
+
+		//the copies are recorded into the frame's graphics work outside of a render pass, the futures resolve in the
+		//prepare_frame after the frame finished
+		std::future<ReadbackData> read_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+		std::future<ReadbackData> read_texture(VkTexture &tex, const VkRect2D &region);
+
+		//timestamps around the graphics work recorded in between, see Atlas::GpuScope. scopes begun while recording
+		//async compute work are not timed
+		uint32_t begin_gpu_scope(const char *name);
+		void end_gpu_scope(uint32_t scope);
+
 		//void draw_objects(VkCommandBuffer cmd, RenderObject *first, uint32_t count);
 		size_t pad_uniform_buffer_size(size_t originalSize);
 
 		VulkanManager &manager();
 		AssetManager &asset_manager();
+		TextureStreamer &texture_streamer();
+		ResidencyManager &residency_manager();
+		UploadBatch &upload_batch();
+		GpuProfiler &gpu_profiler();
+		FrameStatistics &frame_statistics();
 
 		VkFormat get_color_format();
 		VkFormat get_depth_format();
 		VkInstance get_instance();
 		VkPhysicalDevice get_physical_device();
+		const VkPhysicalDeviceProperties &get_gpu_properties();
+		uint32_t get_max_push_descriptors();
+		//blend enable / equation can be set on the command buffer (VK_EXT_extended_dynamic_state3)
+		bool has_dynamic_blend();
 		VkQueue get_graphics_queue();
 		uint32_t get_queue_family_index();
+		//the graphics queue if the device has no separate one
+		VkQueue get_compute_queue();
+		uint32_t get_compute_queue_family();
+		VkQueue get_transfer_queue();
+		uint32_t get_transfer_queue_family();
 		VkRenderPass get_swapchain_renderpass();
 		const VkDevice device();
 		VkCommandBuffer get_active_command_buffer();
 
 		void wait_idle();
 
+		//sets the state pipelines leave dynamic to the values that used to be baked in
+		void reset_dynamic_state(VkCommandBuffer cmd);
+
 		PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR;
+		PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT{ nullptr };
+		PFN_vkCmdSetColorBlendEquationEXT vkCmdSetColorBlendEquationEXT{ nullptr };
 
 	private:
 		void init_vulkan(Window &window);
@@ -110,6 +177,11 @@ namespace vkutil {
 		void init_vp_framebuffers();
 		void rebuild_vp_framebuffer();
 
+		bool prepare_dispatch(VkCommandBuffer cmd);
+		bool prepare_readback(VkBuffer buffer = VK_NULL_HANDLE);
+		void flush_compute_writes(VkCommandBuffer cmd);
+		bool &pending_compute_writes();
+
 		//void load_meshes();
 		//void load_images();
 		//void upload_mesh(Ref<Mesh> mesh);
@@ -129,8 +201,15 @@ namespace vkutil {
 		VkDevice m_Device;
 		VkSurfaceKHR m_Surface;
 		VkPhysicalDeviceProperties m_GPUProperties;
+		uint32_t m_MaxPushDescriptors{ 0 };
+		bool m_DynamicBlend{ false };
+		bool m_PipelineStatistics{ false };
 		VkQueue m_GraphicsQueue;
 		uint32_t m_GraphicsQueueFamily;
+		VkQueue m_ComputeQueue;
+		uint32_t m_ComputeQueueFamily;
+		VkQueue m_TransferQueue;
+		uint32_t m_TransferQueueFamily;
 
 		VkSwapchainKHR m_Swapchain;
 		std::vector<VkImage> m_SwapchainImages;
@@ -143,6 +222,11 @@ namespace vkutil {
 
 		FrameData m_FrameData;
 		DynRenderpassInfo m_DynRenderpassInfo;
+		AsyncComputeInfo m_AsyncCompute;
+
+		//writes that still need a barrier before the other pipeline type reads them
+		bool m_PendingComputeWrites{ false };
+		bool m_PendingGraphicsWrites{ false };
 
 		VkTexture m_ColorTexture;
 		VkTexture m_DepthTexture;
@@ -151,6 +235,12 @@ namespace vkutil {
 
 		VulkanManager m_VkManager;
 		AssetManager m_AssetManager;
+		TextureStreamer m_TextureStreamer;
+		ResidencyManager m_ResidencyManager;
+		UploadBatch m_UploadBatch;
+		ReadbackRing m_ReadbackRing;
+		GpuProfiler m_GpuProfiler;
+		FrameStatistics m_FrameStatistics;
 
 		VmaAllocator m_Allocator;
 
@@ -1,6 +1,8 @@
 #include "vk_initializers.h"
 
 #include "vk_manager.h"
+#include "vk_statistics.h"
+#include "ktx2.h"
 
 #include "imgui_impl_vulkan.h"
 
@@ -109,7 +111,8 @@ namespace vkutil {
 		vmaDestroyBuffer(manager.get_allocator(), stagingBuffer.buffer, stagingBuffer.allocation);
 	}
 
-	void create_image(VulkanManager &manager, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags flags, AllocatedImage *img)
+	void create_image(VulkanManager &manager, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags flags, AllocatedImage *img,
+		uint32_t mipLevels)
 	{
 
 		VkExtent3D imageExtent{};
@@ -117,7 +120,7 @@ namespace vkutil {
 		imageExtent.height = height;
 		imageExtent.depth = 1;
 
-		VkImageCreateInfo dimgInfo = vkinit::image_create_info(format, flags, imageExtent);
+		VkImageCreateInfo dimgInfo = vkinit::image_create_info(format, flags, imageExtent, mipLevels);
 
 		VmaAllocationCreateInfo dimgAllocInfo{};
 		dimgAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
@@ -125,6 +128,122 @@ namespace vkutil {
 		vmaCreateImage(manager.get_allocator(), &dimgInfo, &dimgAllocInfo, &img->image, &img->allocation, nullptr);
 	}
 
+	uint32_t mip_level_count(uint32_t width, uint32_t height)
+	{
+		uint32_t size = std::max(width, height);
+		uint32_t levels = 1;
+		while (size > 1) {
+			size >>= 1;
+			levels++;
+		}
+
+		return levels;
+	}
+
+	bool supports_mip_generation(const VulkanManager &manager, VkFormat format)
+	{
+		VkFormatProperties properties{};
+		vkGetPhysicalDeviceFormatProperties(manager.get_physical_device(), format, &properties);
+
+		VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+			| VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return (properties.optimalTilingFeatures & required) == required;
+	}
+
+	void generate_mipmaps(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels,
+		VkImageLayout finalLayout, VkImageLayout oldLayout, const VkRect2D *region)
+	{
+		VkImageSubresourceRange range{};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.baseArrayLayer = 0;
+		range.layerCount = 1;
+
+		if (mipLevels > 1) {
+			range.baseMipLevel = 1;
+			range.levelCount = mipLevels - 1;
+
+			//levels that were written before may still be blitted into or sampled
+			bool fresh = oldLayout == VK_IMAGE_LAYOUT_UNDEFINED;
+			insert_image_memory_barrier(cmd, image,
+				fresh ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				fresh ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+					: VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				range);
+		}
+
+		range.levelCount = 1;
+
+		int32_t mipWidth = (int32_t)width;
+		int32_t mipHeight = (int32_t)height;
+
+		//the texels of the current level that changed
+		VkOffset2D begin{ 0, 0 };
+		VkOffset2D end{ mipWidth, mipHeight };
+		if (region) {
+			begin = region->offset;
+			end = { begin.x + (int32_t)region->extent.width, begin.y + (int32_t)region->extent.height };
+		}
+
+		//every level is blitted from the previous one, which is done being written at that point
+		for (uint32_t i = 1; i < mipLevels; i++) {
+			range.baseMipLevel = i - 1;
+
+			insert_image_memory_barrier(cmd, image,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				range);
+
+			int32_t nextWidth = std::max(mipWidth / 2, 1);
+			int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+			//an even side halves exactly, so the changed texels map onto whole texels of the next level and the
+			//blit samples the same texels as one over the whole level. odd sides shrink by more than two, they
+			//are blitted whole
+			bool evenX = mipWidth % 2 == 0;
+			bool evenY = mipHeight % 2 == 0;
+			begin = { evenX ? begin.x / 2 : 0, evenY ? begin.y / 2 : 0 };
+			end = { evenX ? (end.x + 1) / 2 : nextWidth, evenY ? (end.y + 1) / 2 : nextHeight };
+
+			VkImageBlit blit{};
+			blit.srcOffsets[0] = { evenX ? begin.x * 2 : 0, evenY ? begin.y * 2 : 0, 0 };
+			blit.srcOffsets[1] = { evenX ? end.x * 2 : mipWidth, evenY ? end.y * 2 : mipHeight, 1 };
+			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel = i - 1;
+			blit.srcSubresource.layerCount = 1;
+			blit.dstOffsets[0] = { begin.x, begin.y, 0 };
+			blit.dstOffsets[1] = { end.x, end.y, 1 };
+			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.dstSubresource.mipLevel = i;
+			blit.dstSubresource.layerCount = 1;
+
+			vkCmdBlitImage(cmd,
+				image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit, VK_FILTER_LINEAR);
+
+			insert_image_memory_barrier(cmd, image,
+				VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, finalLayout,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				range);
+
+			mipWidth = nextWidth;
+			mipHeight = nextHeight;
+		}
+
+		//the last level was only written
+		range.baseMipLevel = mipLevels - 1;
+
+		insert_image_memory_barrier(cmd, image,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			range);
+	}
+
 	TextureCreateInfo color_texture_create_info(uint32_t w, uint32_t h, VkFormat format)
 	{
 		TextureCreateInfo info{};
@@ -148,7 +267,8 @@ namespace vkutil {
 		info.format = format;
 		info.filter = VK_FILTER_LINEAR;
 		info.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
-		info.usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		//nothing reads the depth after the pass, alloc_texture makes it transient
+		info.usageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
 		info.createImguiDescriptor = false;
 
 		return info;
@@ -156,6 +276,12 @@ namespace vkutil {
 
 
 	void set_texture_data(VulkanManager &manager, VkTexture &tex, void *data) {
+		FormatBlockInfo block;
+		if (format_block_info(tex.format, &block) && block.width > 1) {
+			CORE_WARN("Can not set the data of a block compressed texture, format {}", tex.format);
+			return;
+		}
+
 		VkDeviceSize imageSize = (uint64_t)(tex.width * tex.height * 4);
 
 		VkExtent3D imageExtent{};
@@ -206,10 +332,16 @@ namespace vkutil {
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
 			&copyRegion);
 
+		//the other levels are derived from the new data
+		if (tex.mipLevels > 1) {
+			generate_mipmaps(cmd, tex.imageAllocation.image, tex.width, tex.height, tex.mipLevels, tex.layout);
+			return;
+		}
+
 		VkImageMemoryBarrier imageBarrierToReadable = imageBarrierToTransfer;
 
 		imageBarrierToReadable.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		imageBarrierToReadable.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageBarrierToReadable.newLayout = tex.layout;
 
 		imageBarrierToReadable.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		imageBarrierToReadable.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
@@ -222,14 +354,29 @@ namespace vkutil {
 		vmaDestroyBuffer(manager.get_allocator(), stagingBuffer.buffer, stagingBuffer.allocation);
 	}
 
-	void destroy_texture(const VulkanManager &manager, VkTexture &tex) {
+	void destroy_texture(VulkanManager &manager, VkTexture &tex) {
 		vkDestroyImageView(manager.device(), tex.imageView, nullptr);
-		vmaDestroyImage(manager.get_allocator(), tex.imageAllocation.image, tex.imageAllocation.allocation);
 
-		if (tex.bImguiDescriptor) {
-			ImGui_ImplVulkan_RemoveTexture((VkDescriptorSet)tex.imguiDescriptor);
-			vkDestroySampler(manager.device(), tex.sampler, nullptr);
+		if (tex.transient) manager.get_transient_allocator().destroy_image(tex.imageAllocation);
+		else vmaDestroyImage(manager.get_allocator(), tex.imageAllocation.image, tex.imageAllocation.allocation);
+
+		if (tex.imguiDescriptor) {
+			ImGui_ImplVulkan_RemoveTexture(tex.imguiDescriptor);
+			tex.imguiDescriptor = VK_NULL_HANDLE;
 		}
+
+		manager.get_sampler_cache().release(tex.sampler);
+		tex.sampler = VK_NULL_HANDLE;
+	}
+
+	VkDescriptorSet imgui_descriptor(VkTexture &tex)
+	{
+		if (!tex.bImguiDescriptor) return VK_NULL_HANDLE;
+
+		//most textures are never shown through imgui, its descriptor pool is small
+		if (!tex.imguiDescriptor) tex.imguiDescriptor = ImGui_ImplVulkan_AddTexture(tex.sampler, tex.imageView, tex.layout);
+
+		return tex.imguiDescriptor;
 	}
 
 	void insert_image_memory_barrier(VkCommandBuffer command_buffer, VkImage image, VkAccessFlags src_access_mask,
@@ -258,6 +405,8 @@ namespace vkutil {
 			0, nullptr,
 			0, nullptr,
 			1, &barrier);
+
+		count(FrameCounter::BARRIERS);
 	}
 
 
@@ -265,52 +414,75 @@ namespace vkutil {
 	{
 		tex->width = info.width;
 		tex->height = info.height;
+		tex->mipLevels = std::max(info.mipLevels, 1u);
 		tex->format = info.format;
 		tex->bImguiDescriptor = info.createImguiDescriptor;
+		tex->layout = info.usageFlags & VK_IMAGE_USAGE_STORAGE_BIT ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
 		if (info.createImguiDescriptor)
 			info.usageFlags |= VK_IMAGE_USAGE_SAMPLED_BIT;
 
-		create_image(manager, info.width, info.height, info.format, info.usageFlags, &tex->imageAllocation);
+		//set_texture_data blits the mips from level 0
+		if (tex->mipLevels > 1)
+			info.usageFlags |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+		//attachments nothing samples, copies or loads are never stored, they alias the memory of the other transient
+		//attachments of their format
+		const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		tex->transient = (info.usageFlags & attachmentUsage) && !(info.usageFlags & ~attachmentUsage);
+
+		if (tex->transient) {
+			VkExtent3D extent = { info.width, info.height, 1 };
+			VkImageCreateInfo imageCreateInfo = vkinit::image_create_info(info.format,
+				info.usageFlags | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, extent, tex->mipLevels);
+
+			manager.get_transient_allocator().create_image(imageCreateInfo, &tex->imageAllocation);
+		}
+		else {
+			create_image(manager, info.width, info.height, info.format, info.usageFlags, &tex->imageAllocation, tex->mipLevels);
+		}
 
 		VkImageViewCreateInfo imageInfo = vkinit::imageview_create_info(
 			info.format, tex->imageAllocation.image,
-			info.aspectFlags);
+			info.aspectFlags, tex->mipLevels);
 
 		vkCreateImageView(manager.device(), &imageInfo, nullptr, &tex->imageView);
 
 
 		if (info.createImguiDescriptor) {
-			VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(info.filter);
-			VK_CHECK(vkCreateSampler(manager.device(), &samplerInfo, nullptr, &tex->sampler));
-			tex->imguiDescriptor = ImGui_ImplVulkan_AddTexture(tex->sampler, tex->imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			VkSamplerCreateInfo samplerInfo = vkinit::sampler_create_info(info.filter, VK_SAMPLER_ADDRESS_MODE_REPEAT,
+				(float)tex->mipLevels);
+			tex->sampler = manager.get_sampler_cache().acquire(samplerInfo);
 		}
 
-		if (info.usageFlags & (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT)) {
+		if (info.usageFlags & (VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT)) {
 
 			manager.immediate_submit([=](VkCommandBuffer cmd) {
 				VkImageSubresourceRange range{};
 			range.aspectMask = info.aspectFlags;
-			range.levelCount = 1;
+			range.levelCount = tex->mipLevels;
 			range.layerCount = 1;
 
 			insert_image_memory_barrier(cmd, tex->imageAllocation.image,
 				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, tex->layout,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
 				range);
 			});
 		}
 	}
 
-	bool load_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex) {
+	bool load_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex, bool mipmaps) {
 		//Ref<Texture> tex = make_ref<Texture>();
 		CORE_ASSERT(tex->imageAllocation.image == VK_NULL_HANDLE, "VkImage is not VK_NULL_HANDLE, overriding not allowed");
 
+		if (std::filesystem::path(file).extension() == ".ktx2") return load_ktx2_texture(file, manager, info, tex);
+
 		tex->format = VK_FORMAT_R8G8B8A8_UNORM;
 
 		int w, h, nC;
-		if (!load_alloc_image_from_file(file, manager, &tex->imageAllocation, &w, &h, &nC, tex->format)) {
+		if (!load_alloc_image_from_file(file, manager, &tex->imageAllocation, &w, &h, &nC, tex->format,
+			mipmaps ? &tex->mipLevels : nullptr)) {
 			return false;
 		}
 
@@ -319,20 +491,110 @@ namespace vkutil {
 
 		VkImageViewCreateInfo imageInfo = vkinit::imageview_create_info(
 			tex->format, tex->imageAllocation.image,
-			VK_IMAGE_ASPECT_COLOR_BIT);
+			VK_IMAGE_ASPECT_COLOR_BIT, tex->mipLevels);
 
 		vkCreateImageView(manager.device(), &imageInfo, nullptr, &tex->imageView);
 
-		VK_CHECK(vkCreateSampler(manager.device(), &info, nullptr, &tex->sampler));
+		info.maxLod = (float)tex->mipLevels;
+
+		tex->sampler = manager.get_sampler_cache().acquire(info);
+
+		tex->bImguiDescriptor = true;
+
+		return true;
+	}
+
+	bool supports_sampled_format(const VulkanManager &manager, VkFormat format, VkFilter filter)
+	{
+		VkFormatProperties properties{};
+		vkGetPhysicalDeviceFormatProperties(manager.get_physical_device(), format, &properties);
+
+		VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+		if (filter == VK_FILTER_LINEAR) required |= VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		return (properties.optimalTilingFeatures & required) == required;
+	}
+
+	bool load_ktx2_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex)
+	{
+		Ktx2Image image;
+		std::string error;
+		if (!read_ktx2(file, &image, &error)) {
+			CORE_WARN("Failed to load texture file: {}, message: {}", file, error);
+			return false;
+		}
+
+		if (!supports_sampled_format(manager, image.format, info.minFilter)) {
+			CORE_WARN("Failed to load texture file: {}, format {} can not be sampled on this device", file, image.format);
+			return false;
+		}
+
+		tex->format = image.format;
+		tex->width = image.width;
+		tex->height = image.height;
+		tex->mipLevels = (uint32_t)image.levels.size();
+
+		AllocatedBuffer stagingBuffer;
+		create_buffer(manager, image.data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer);
+
+		map_memory(manager, stagingBuffer, image.data.data(), (uint32_t)image.data.size());
+
+		create_image(manager, tex->width, tex->height, tex->format,
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, &tex->imageAllocation, tex->mipLevels);
+
+		//every level is stored in the file, the payload is copied as is
+		std::vector<VkBufferImageCopy> regions;
+		for (uint32_t level = 0; level < tex->mipLevels; level++) {
+			VkBufferImageCopy region{};
+			region.bufferOffset = image.levels[level].offset;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { std::max(1u, tex->width >> level), std::max(1u, tex->height >> level), 1 };
+
+			regions.push_back(region);
+		}
+
+		manager.immediate_submit([&](VkCommandBuffer cmd) {
+			VkImageSubresourceRange range{};
+			range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			range.levelCount = tex->mipLevels;
+			range.layerCount = 1;
+
+			insert_image_memory_barrier(cmd, tex->imageAllocation.image,
+				0, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				range);
+
+			vkCmdCopyBufferToImage(cmd, stagingBuffer.buffer, tex->imageAllocation.image,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+			insert_image_memory_barrier(cmd, tex->imageAllocation.image,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, tex->layout,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				range);
+		});
+
+		vmaDestroyBuffer(manager.get_allocator(), stagingBuffer.buffer, stagingBuffer.allocation);
+
+		VkImageViewCreateInfo imageInfo = vkinit::imageview_create_info(
+			tex->format, tex->imageAllocation.image,
+			VK_IMAGE_ASPECT_COLOR_BIT, tex->mipLevels);
+
+		vkCreateImageView(manager.device(), &imageInfo, nullptr, &tex->imageView);
+
+		info.maxLod = (float)tex->mipLevels;
+
+		tex->sampler = manager.get_sampler_cache().acquire(info);
 
-		tex->imguiDescriptor = ImGui_ImplVulkan_AddTexture(tex->sampler, tex->imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 		tex->bImguiDescriptor = true;
 
 		return true;
 	}
 
 	bool load_alloc_image_from_file(const char *file, VulkanManager &manager,
-		AllocatedImage *outImage, int *w, int *h, int *nC, VkFormat format) {
+		AllocatedImage *outImage, int *w, int *h, int *nC, VkFormat format, uint32_t *mipLevels) {
 
 		stbi_uc *pixel_ptr = stbi_load(file, w, h, nC, STBI_rgb_alpha);
 
@@ -359,8 +621,19 @@ namespace vkutil {
 		imageExtent.height = static_cast<uint32_t>(height);
 		imageExtent.depth = 1;
 
+		uint32_t levels = 1;
+		if (mipLevels) {
+			if (supports_mip_generation(manager, format)) levels = mip_level_count(imageExtent.width, imageExtent.height);
+			else CORE_WARN("Can not generate mipmaps for: {}, format {} does not support linear blits", file, format);
+
+			*mipLevels = levels;
+		}
+
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		if (levels > 1) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
 		AllocatedImage img;
-		create_image(manager, imageExtent.width, imageExtent.height, format, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, &img);
+		create_image(manager, imageExtent.width, imageExtent.height, format, usage, &img, levels);
 
 		manager.immediate_submit([&](VkCommandBuffer cmd) {
 			VkImageSubresourceRange range{};
@@ -400,6 +673,12 @@ namespace vkutil {
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
 			&copyRegion);
 
+		if (levels > 1) {
+			generate_mipmaps(cmd, img.image, imageExtent.width, imageExtent.height, levels,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			return;
+		}
+
 		VkImageMemoryBarrier imageBarrierToReadable = imageBarrierToTransfer;
 
 		imageBarrierToReadable.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -510,6 +789,28 @@ namespace vkinit {
 		return info;
 	}
 
+	VkCommandBufferSubmitInfo command_buffer_submit_info(VkCommandBuffer cmd) {
+		VkCommandBufferSubmitInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+		info.pNext = nullptr;
+		info.commandBuffer = cmd;
+		info.deviceMask = 0;
+
+		return info;
+	}
+
+	VkSemaphoreSubmitInfo semaphore_submit_info(VkPipelineStageFlags2 stageMask, VkSemaphore semaphore) {
+		VkSemaphoreSubmitInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		info.pNext = nullptr;
+		info.semaphore = semaphore;
+		info.stageMask = stageMask;
+		info.deviceIndex = 0;
+		info.value = 0;
+
+		return info;
+	}
+
 	VkPresentInfoKHR present_info() {
 		VkPresentInfoKHR info{};
 		info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -651,7 +952,7 @@ namespace vkinit {
 
 	VkImageCreateInfo image_create_info(VkFormat format,
 		VkImageUsageFlags usageFlags,
-		VkExtent3D extent) {
+		VkExtent3D extent, uint32_t mipLevels) {
 		VkImageCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 		info.pNext = nullptr;
@@ -661,7 +962,7 @@ namespace vkinit {
 		info.format = format;
 		info.extent = extent;
 
-		info.mipLevels = 1;
+		info.mipLevels = mipLevels;
 		info.arrayLayers = 1;
 		info.samples = VK_SAMPLE_COUNT_1_BIT;
 		info.tiling = VK_IMAGE_TILING_OPTIMAL; // use linear for access from the cpu
@@ -670,7 +971,7 @@ namespace vkinit {
 		return info;
 	}
 	VkImageViewCreateInfo imageview_create_info(VkFormat format, VkImage image,
-		VkImageAspectFlags aspectFlags) {
+		VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
 		VkImageViewCreateInfo info{};
 		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 		info.pNext = nullptr;
@@ -679,7 +980,7 @@ namespace vkinit {
 		info.image = image;
 		info.format = format;
 		info.subresourceRange.baseMipLevel = 0;
-		info.subresourceRange.levelCount = 1;
+		info.subresourceRange.levelCount = mipLevels;
 		info.subresourceRange.baseArrayLayer = 0;
 		info.subresourceRange.layerCount = 1;
 		info.subresourceRange.aspectMask = aspectFlags;
@@ -732,17 +1033,24 @@ namespace vkinit {
 		return write;
 	}
 
-	VkSamplerCreateInfo sampler_create_info(VkFilter filters, VkSamplerAddressMode samplerAdressMode /*= VK_SAMPLER_ADDRESS_MODE_REPEAT*/) {
+	VkSamplerCreateInfo sampler_create_info(VkFilter filters, VkSamplerAddressMode samplerAdressMode /*= VK_SAMPLER_ADDRESS_MODE_REPEAT*/,
+		float maxLod, float maxAnisotropy) {
 		VkSamplerCreateInfo info = {};
 		info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 		info.pNext = nullptr;
 
 		info.magFilter = filters;
 		info.minFilter = filters;
+		info.mipmapMode = filters == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
 		info.addressModeU = samplerAdressMode;
 		info.addressModeV = samplerAdressMode;
 		info.addressModeW = samplerAdressMode;
 
+		info.minLod = 0.0f;
+		info.maxLod = maxLod;
+		info.anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+		info.maxAnisotropy = std::max(maxAnisotropy, 1.0f);
+
 		return info;
 	}
 
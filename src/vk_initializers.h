@@ -15,7 +15,19 @@ namespace vkutil {
 	void destroy_buffer(VulkanManager &manager, AllocatedBuffer &buffer);
 
 	// --- Image util functions ---
-	void create_image(VulkanManager &manager, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags flags, AllocatedImage *img);
+	void create_image(VulkanManager &manager, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags flags, AllocatedImage *img,
+		uint32_t mipLevels = 1);
+
+	//length of the full mip chain, down to 1x1
+	uint32_t mip_level_count(uint32_t width, uint32_t height);
+	//mips are generated with linear blits, which not every format supports
+	bool supports_mip_generation(const VulkanManager &manager, VkFormat format);
+	//level 0 has to be in TRANSFER_DST_OPTIMAL, the other levels are overwritten. every level ends up in finalLayout.
+	//oldLayout is the layout of the other levels, with anything but UNDEFINED earlier transfers and shader reads of
+	//them are waited for. with a region (texels of level 0) only the texels that depend on it are blitted again,
+	//which needs an oldLayout that keeps the rest
+	void generate_mipmaps(VkCommandBuffer cmd, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels,
+		VkImageLayout finalLayout, VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED, const VkRect2D *region = nullptr);
 
 
 	void insert_image_memory_barrier(
@@ -33,12 +45,21 @@ namespace vkutil {
 	TextureCreateInfo depth_texture_create_info(uint32_t w, uint32_t h, VkFormat format);
 	void alloc_texture(VulkanManager &manager, TextureCreateInfo &info, VkTexture *tex);
 	void set_texture_data(VulkanManager &manager, VkTexture &tex, void *data);
+	//formats the device can sample with filter and upload to
+	bool supports_sampled_format(const VulkanManager &manager, VkFormat format, VkFilter filter);
 	//std::optional<Ref<Texture>> load_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info);
-	bool load_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex);
+	//the maxLod of info is set to the mip count of the loaded image
+	bool load_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex, bool mipmaps = true);
+	//block compressed KTX2 payloads are uploaded as is, including their mips. load_texture forwards .ktx2 files here
+	bool load_ktx2_texture(const char *file, VulkanManager &manager, VkSamplerCreateInfo &info, VkTexture *tex);
+	//a full mip chain is generated if mipLevels is given, its length is written back
 	bool load_alloc_image_from_file(const char *file, VulkanManager &manager,
-		AllocatedImage *outImage, int *width, int *height, int *nChannels, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+		AllocatedImage *outImage, int *width, int *height, int *nChannels, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM,
+		uint32_t *mipLevels = nullptr);
 
-	void destroy_texture(const VulkanManager &manager, VkTexture &tex);
+	void destroy_texture(VulkanManager &manager, VkTexture &tex);
+	//creates the imgui descriptor set of the texture on first use, destroy_texture frees it
+	VkDescriptorSet imgui_descriptor(VkTexture &tex);
 
 }
 
@@ -64,6 +85,9 @@ namespace vkinit {
 
 	VkSubmitInfo submit_info(VkCommandBuffer *cmd);
 
+	VkCommandBufferSubmitInfo command_buffer_submit_info(VkCommandBuffer cmd);
+	VkSemaphoreSubmitInfo semaphore_submit_info(VkPipelineStageFlags2 stageMask, VkSemaphore semaphore);
+
 	VkPresentInfoKHR present_info();
 
 	VkRenderPassBeginInfo renderpass_begin_info(VkRenderPass renderPass,
@@ -90,9 +114,9 @@ namespace vkinit {
 
 	VkImageCreateInfo image_create_info(VkFormat format,
 		VkImageUsageFlags usageFlags,
-		VkExtent3D extent);
+		VkExtent3D extent, uint32_t mipLevels = 1);
 	VkImageViewCreateInfo imageview_create_info(VkFormat format, VkImage image,
-		VkImageAspectFlags aspectFlags);
+		VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
 
 	VkPipelineDepthStencilStateCreateInfo
 		depth_stencil_create_info(bool depthTest, bool depthWrite,
@@ -107,9 +131,11 @@ namespace vkinit {
 		VkDescriptorBufferInfo *bufferInfo,
 		uint32_t binding);
 
+	//mips are sampled up to maxLod, anisotropic filtering is enabled for maxAnisotropy > 1
 	VkSamplerCreateInfo sampler_create_info(
 		VkFilter filters,
-		VkSamplerAddressMode samplerAddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT);
+		VkSamplerAddressMode samplerAddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		float maxLod = 0.0f, float maxAnisotropy = 1.0f);
 
 	VkWriteDescriptorSet write_descriptor_image(VkDescriptorType type,
 		VkDescriptorSet dstSet,
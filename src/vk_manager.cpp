@@ -7,14 +7,169 @@ namespace vkutil {
 		m_Device = device;
 		m_Allocator = allocator;
 
-		m_DescriptorAllocator = DescriptorAllocator(m_Device);
-		m_DescriptorLayoutCache = DescriptorLayoutCache(m_Device);
-		m_PipelineLayoutCache = PipelineLayoutCache(m_Device);
+		m_DescriptorAllocator.init(m_Device);
+		m_DescriptorLayoutCache.init(m_Device);
+		m_SamplerCache.init(m_Device);
+		m_TransientAllocator.init(m_Device, m_Allocator);
+		m_PipelineLayoutCache.init(m_Device);
+	}
+
+	void VulkanManager::init_physical_device(VkPhysicalDevice physicalDevice, float maxAnisotropy) {
+		m_PhysicalDevice = physicalDevice;
+		m_MaxAnisotropy = maxAnisotropy;
+	}
+
+	struct PipelineCacheHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t dataSize;
+		uint64_t dataHash;
+	};
+
+	static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43505441; //"ATPC"
+	static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+	static PipelineCacheHeader pipeline_cache_header(const VkPhysicalDeviceProperties &properties) {
+		PipelineCacheHeader header{};
+		header.magic = PIPELINE_CACHE_MAGIC;
+		header.version = PIPELINE_CACHE_VERSION;
+		header.vendorID = properties.vendorID;
+		header.deviceID = properties.deviceID;
+		header.driverVersion = properties.driverVersion;
+		std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return header;
+	}
+
+	static std::vector<char> read_pipeline_cache(const std::filesystem::path &path, const VkPhysicalDeviceProperties &properties) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) return {};
+
+		size_t fileSize = (size_t)file.tellg();
+		if (fileSize < sizeof(PipelineCacheHeader)) return {};
+
+		PipelineCacheHeader header{};
+		file.seekg(0);
+		file.read((char *)&header, sizeof(PipelineCacheHeader));
+
+		PipelineCacheHeader expected = pipeline_cache_header(properties);
+
+		if (header.magic != expected.magic || header.version != expected.version ||
+			header.vendorID != expected.vendorID || header.deviceID != expected.deviceID ||
+			header.driverVersion != expected.driverVersion ||
+			std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+			CORE_TRACE("Pipeline cache {} was created by a different device or driver, ignoring it", path.string());
+			return {};
+		}
+
+		if (header.dataSize != fileSize - sizeof(PipelineCacheHeader)) {
+			CORE_WARN("Pipeline cache {} is truncated, ignoring it", path.string());
+			return {};
+		}
+
+		std::vector<char> data(header.dataSize);
+		file.read(data.data(), data.size());
+
+		if (hash_bytes(data.data(), data.size()) != header.dataHash) {
+			CORE_WARN("Pipeline cache {} is corrupted, ignoring it", path.string());
+			return {};
+		}
+
+		return data;
+	}
+
+	void VulkanManager::init_pipeline_cache(const VkPhysicalDeviceProperties &properties, const std::filesystem::path &path) {
+		CORE_ASSERT(m_Device, "ResourceManager not initialized");
+
+		m_PipelineCacheProperties = properties;
+		m_PipelineCachePath = path;
+
+		std::vector<char> data = read_pipeline_cache(path, properties);
+
+		VkPipelineCacheCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		info.initialDataSize = data.size();
+		info.pInitialData = data.empty() ? nullptr : data.data();
+
+		VkResult res = vkCreatePipelineCache(m_Device, &info, nullptr, &m_PipelineCache);
+
+		//the driver can still reject the data, start with an empty cache in that case
+		if (res != VK_SUCCESS && !data.empty()) {
+			CORE_WARN("Driver rejected pipeline cache {}, starting with an empty cache", path.string());
+			info.initialDataSize = 0;
+			info.pInitialData = nullptr;
+			res = vkCreatePipelineCache(m_Device, &info, nullptr, &m_PipelineCache);
+		}
+
+		VK_CHECK(res);
+
+		CORE_TRACE("Loaded pipeline cache: {} bytes", data.size());
+	}
+
+	void VulkanManager::save_pipeline_cache() {
+		if (m_PipelineCache == VK_NULL_HANDLE || m_PipelineCachePath.empty()) return;
+
+		size_t size = 0;
+		VK_CHECK(vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr));
+
+		std::vector<char> data(size);
+		VK_CHECK(vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, data.data()));
+		data.resize(size);
+
+		PipelineCacheHeader header = pipeline_cache_header(m_PipelineCacheProperties);
+		header.dataSize = data.size();
+		header.dataHash = hash_bytes(data.data(), data.size());
+
+		std::error_code ec;
+		if (m_PipelineCachePath.has_parent_path()) std::filesystem::create_directories(m_PipelineCachePath.parent_path(), ec);
+
+		//write to a temporary file first, so a crash while saving never leaves a half written cache behind
+		std::filesystem::path tmpPath = m_PipelineCachePath;
+		tmpPath += ".tmp";
+
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				CORE_WARN("Could not write pipeline cache: {}", tmpPath.string());
+				return;
+			}
+
+			file.write((const char *)&header, sizeof(PipelineCacheHeader));
+			file.write(data.data(), data.size());
+		}
+
+		std::filesystem::rename(tmpPath, m_PipelineCachePath, ec);
+		if (ec) CORE_WARN("Could not write pipeline cache: {}", ec.message());
 	}
 
 	void VulkanManager::cleanup() {
+		CacheStats descStats = m_DescriptorLayoutCache.get_stats();
+		CacheStats pipeStats = m_PipelineLayoutCache.get_stats();
+		CORE_TRACE("DescriptorLayoutCache: {} layouts, {} hits, {} misses", descStats.size, descStats.hits, descStats.misses);
+		CORE_TRACE("PipelineLayoutCache: {} layouts, {} hits, {} misses", pipeStats.size, pipeStats.hits, pipeStats.misses);
+
+		CacheStats samplerStats = m_SamplerCache.get_stats();
+		CORE_TRACE("SamplerCache: {} samplers, {} hits, {} misses", samplerStats.size, samplerStats.hits, samplerStats.misses);
+
+		TransientStats transientStats = m_TransientAllocator.get_stats();
+		CORE_TRACE("TransientAllocator: {} images in {} blocks ({} lazily allocated), {} bytes", transientStats.images,
+			transientStats.blocks, transientStats.lazyBlocks, transientStats.bytes);
+
+		DescriptorPoolStats poolStats = m_DescriptorAllocator.get_stats();
+		CORE_TRACE("DescriptorAllocator: {} pools created, {} in use, {} failed allocations, {:.1f}% unused capacity",
+			poolStats.createdPools, poolStats.usedPools, poolStats.failedAllocations, poolStats.unusedCapacity * 100.0f);
+
+		save_pipeline_cache();
+		if (m_PipelineCache) vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+		m_PipelineCache = VK_NULL_HANDLE;
+
 		m_DeletionQueue.flush();
 		m_DescriptorLayoutCache.cleanup();
+		m_SamplerCache.cleanup();
+		m_TransientAllocator.cleanup();
 		m_DescriptorAllocator.cleanup();
 		m_PipelineLayoutCache.cleanup();
 	}
@@ -43,12 +198,37 @@ namespace vkutil {
 		return m_DescriptorLayoutCache;
 	}
 
+	SamplerCache &VulkanManager::get_sampler_cache() {
+		CORE_ASSERT(m_Device, "ResourceManager not initialized");
+		return m_SamplerCache;
+	}
+
+	TransientAllocator &VulkanManager::get_transient_allocator() {
+		CORE_ASSERT(m_Device, "ResourceManager not initialized");
+		return m_TransientAllocator;
+	}
+
 	PipelineLayoutCache &VulkanManager::get_pipeline_layout_cache()
 	{
 		CORE_ASSERT(m_Device, "ResourceManager not initialized");
 		return m_PipelineLayoutCache;
 	}
 
+	VkPipelineCache VulkanManager::get_pipeline_cache() const
+	{
+		return m_PipelineCache;
+	}
+
+	VkPhysicalDevice VulkanManager::get_physical_device() const
+	{
+		return m_PhysicalDevice;
+	}
+
+	float VulkanManager::get_max_anisotropy() const
+	{
+		return m_MaxAnisotropy;
+	}
+
 	void VulkanManager::init_commands(VkQueue queue, uint32_t queueFamilyIndex) {
 		CORE_ASSERT(m_Device, "ResourceManager not initialized");
 
@@ -111,6 +291,9 @@ namespace vkutil {
 	void AssetManager::cleanup(VulkanManager &manager) {
 		destroy_queued(manager);
 
+		if (!m_Pipelines.empty()) CORE_WARN("AssetManager: {} shared pipelines were never released", m_Pipelines.size());
+		m_Pipelines.clear();
+
 		for (auto &shader : m_Shaders) vkDestroyPipeline(manager.device(), shader->pipeline, nullptr);
 		for (auto &texture : m_Textures) destroy_texture(manager, *texture.get());
 		for (auto &buffer : m_Buffers) destroy_buffer(manager, *buffer.get());
@@ -122,11 +305,15 @@ namespace vkutil {
 
 	void AssetManager::destroy_queued(VulkanManager &manager)
 	{
-		for (auto &shader : m_DeletedShaders) vkDestroyPipeline(manager.device(), shader->pipeline, nullptr);
+		{
+			std::scoped_lock lock(m_ShaderMutex);
+			for (auto &shader : m_DeletedShaders) vkDestroyPipeline(manager.device(), shader->pipeline, nullptr);
+			m_DeletedShaders.clear();
+		}
+
 		for (auto &texture : m_DeletedTextures) destroy_texture(manager, *texture.get());
 		for (auto &buffer : m_DeletedBuffers) destroy_buffer(manager, *buffer.get());
 
-		m_DeletedShaders.clear();
 		m_DeletedTextures.clear();
 		m_DeletedBuffers.clear();
 	}
@@ -152,7 +339,57 @@ namespace vkutil {
 		m_Buffers.erase(it);
 	}
 
+	Ref<Shader> AssetManager::acquire_shader(VulkanManager &manager, const PipelineKey &key, const std::function<bool(Shader *)> &create) {
+		{
+			std::scoped_lock lock(m_ShaderMutex);
+
+			auto it = m_Pipelines.find(key);
+			if (it != m_Pipelines.end()) {
+				it->second.refCount++;
+				return it->second.shader;
+			}
+		}
+
+		//building can take a while, don't hold the lock for it
+		Shader shader{};
+		if (!create(&shader)) return nullptr;
+		shader.key = key;
+
+		std::scoped_lock lock(m_ShaderMutex);
+
+		//another thread could have built the same pipeline in the meantime
+		auto it = m_Pipelines.find(key);
+		if (it != m_Pipelines.end()) {
+			vkDestroyPipeline(manager.device(), shader.pipeline, nullptr);
+			it->second.refCount++;
+			return it->second.shader;
+		}
+
+		Ref<Shader> ref = make_ref<Shader>(shader);
+		m_Pipelines.emplace(key, PipelineEntry{ ref, 1 });
+		m_Shaders.insert(ref);
+
+		return ref;
+	}
+
+	void AssetManager::release_shader(Ref<Shader> &shader) {
+		std::scoped_lock lock(m_ShaderMutex);
+
+		auto it = m_Pipelines.find(shader->key);
+		if (it == m_Pipelines.end() || it->second.shader != shader) {
+			CORE_WARN("Shader was never acquired: {}", shader);
+			return;
+		}
+
+		if (--it->second.refCount > 0) return;
+
+		m_Pipelines.erase(it);
+		m_Shaders.erase(shader);
+		m_DeletedShaders.insert(shader);
+	}
+
 	void AssetManager::queue_destroy_shader(Ref<Shader> &shader) {
+		std::scoped_lock lock(m_ShaderMutex);
 		auto it = m_Shaders.find(shader);
 
 		if (it == m_Shaders.end()) {
@@ -164,6 +401,7 @@ namespace vkutil {
 	}
 
 	void AssetManager::deregister_shader(Ref<Shader> &shader) {
+		std::scoped_lock lock(m_ShaderMutex);
 		auto it = m_Shaders.find(shader);
 
 		if (it == m_Shaders.end()) {
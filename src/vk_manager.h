@@ -3,6 +3,8 @@
 #include "vk_types.h"
 #include "vk_descriptors.h"
 #include "vk_pipeline.h"
+#include "vk_sampler.h"
+#include "vk_transient.h"
 
 namespace vkutil {
 
@@ -37,10 +39,20 @@ namespace vkutil {
 		const VmaAllocator get_allocator() const;
 		DescriptorAllocator &get_descriptor_allocator();
 		DescriptorLayoutCache &get_descriptor_layout_cache();
+		SamplerCache &get_sampler_cache();
+		TransientAllocator &get_transient_allocator();
 
 		PipelineLayoutCache &get_pipeline_layout_cache();
+		VkPipelineCache get_pipeline_cache() const;
+
+		VkPhysicalDevice get_physical_device() const;
+		float get_max_anisotropy() const;
 
 		void init(VkDevice device, VmaAllocator allocator);
+		//maxAnisotropy is 1 if the device does not support anisotropic filtering
+		void init_physical_device(VkPhysicalDevice physicalDevice, float maxAnisotropy);
+		//loads the pipeline cache from disk if it was written by the same device and driver
+		void init_pipeline_cache(const VkPhysicalDeviceProperties &properties, const std::filesystem::path &path);
 		void init_commands(VkQueue queue, uint32_t queueFamilyIndex);
 		void init_sync_structures();
 
@@ -55,6 +67,8 @@ namespace vkutil {
 
 		VkDevice m_Device{ VK_NULL_HANDLE };
 		VmaAllocator m_Allocator{ VK_NULL_HANDLE };
+		VkPhysicalDevice m_PhysicalDevice{ VK_NULL_HANDLE };
+		float m_MaxAnisotropy{ 1.0f };
 
 		VkQueue m_Queue{ VK_NULL_HANDLE };
 		uint32_t m_QueueFamilyIndex{ 0 };
@@ -65,8 +79,16 @@ namespace vkutil {
 
 		DescriptorAllocator m_DescriptorAllocator;
 		DescriptorLayoutCache m_DescriptorLayoutCache;
+		SamplerCache m_SamplerCache;
+		TransientAllocator m_TransientAllocator;
 
 		PipelineLayoutCache m_PipelineLayoutCache;
+
+		VkPipelineCache m_PipelineCache{ VK_NULL_HANDLE };
+		VkPhysicalDeviceProperties m_PipelineCacheProperties{};
+		std::filesystem::path m_PipelineCachePath;
+
+		void save_pipeline_cache();
 	};
 
 	class AssetManager {
@@ -86,11 +108,18 @@ namespace vkutil {
 		template<typename ...Args>
 		WeakRef<Shader> register_shader(Args &&...args) {
 			Ref<Shader> shader = make_ref<Shader>(std::forward<Args>(args)...);
+
+			std::scoped_lock lock(m_ShaderMutex);
 			m_Shaders.insert(shader);
 
 			return shader;
 		}
 
+		//returns the pipeline registered under key, or builds it with create. every acquire needs a release_shader
+		Ref<Shader> acquire_shader(VulkanManager &manager, const PipelineKey &key, const std::function<bool(Shader *)> &create);
+		//destruction of the pipeline is queued once the last user released it
+		void release_shader(Ref<Shader> &shader);
+
 		template<typename ...Args>
 		WeakRef<AllocatedBuffer> register_buffer(Args &&...args) {
 			Ref<AllocatedBuffer> buffer = make_ref<AllocatedBuffer>(std::forward<Args>(args)...);
@@ -107,6 +136,20 @@ namespace vkutil {
 		void deregister_texture(Ref<VkTexture> &texture);
 
 	private:
+		struct PipelineEntry {
+			Ref<Shader> shader;
+			uint32_t refCount{ 0 };
+		};
+
+		struct PipelineKeyHash {
+			std::size_t operator()(const PipelineKey &k) const {
+				return k.hash;
+			}
+		};
+
+		std::mutex m_ShaderMutex;
+		std::unordered_map<PipelineKey, PipelineEntry, PipelineKeyHash> m_Pipelines;
+
 		std::unordered_set<Ref<Shader>> m_Shaders;
 		std::unordered_set<Ref<VkTexture>> m_Textures;
 		std::unordered_set<Ref<AllocatedBuffer>> m_Buffers;
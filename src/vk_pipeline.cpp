@@ -6,6 +6,13 @@
 #include <spirv_cross/spirv_reflect.hpp>
 #include <spirv_cross/spirv_cross.hpp>
 
+static std::string read_shader_include(const std::string &name) {
+	std::ifstream is(name);
+	std::stringstream buffer;
+	buffer << is.rdbuf();
+	return buffer.str();
+}
+
 class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
 {
 	shaderc_include_result *GetInclude(
@@ -16,11 +23,7 @@ class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
 	{
 		const std::string name = requested_source;
 
-		std::ifstream is(name);
-		std::stringstream buffer;
-		buffer << is.rdbuf();
-
-		std::string contents = buffer.str();
+		std::string contents = read_shader_include(name);
 
 		auto container = new std::array<std::string, 2>;
 		(*container)[0] = name;
@@ -71,6 +74,11 @@ namespace vkutil {
 	}
 
 
+	void PipelineLayoutCache::init(VkDevice device)
+	{
+		m_Device = device;
+	}
+
 	VkPipelineLayout PipelineLayoutCache::create_pipeline_layout(VkPipelineLayoutCreateInfo &info)
 	{
 		CORE_ASSERT(m_Device, "PipelineLayoutCache is not initialized");
@@ -81,23 +89,29 @@ namespace vkutil {
 			layoutInfo.m_Layouts.push_back(info.pSetLayouts[i]);
 		}
 
-		auto it = m_LayoutCache.find(layoutInfo);
+		for (uint32_t i = 0; i < info.pushConstantRangeCount; i++) {
+			layoutInfo.m_PushConstants.push_back(info.pPushConstantRanges[i]);
+		}
 
-		if (it != m_LayoutCache.end()) return (*it).second;
-		else {
+		return m_LayoutCache.get_or_create(layoutInfo, [&]() {
 			VkPipelineLayout layout;
-			vkCreatePipelineLayout(m_Device, &info, nullptr, &layout);
-
-			m_LayoutCache[layoutInfo] = layout;
+			VK_CHECK(vkCreatePipelineLayout(m_Device, &info, nullptr, &layout));
 			return layout;
-		}
+		});
 	}
 
 	void PipelineLayoutCache::cleanup()
 	{
-		for (auto &pair : m_LayoutCache) {
-			vkDestroyPipelineLayout(m_Device, pair.second, nullptr);
-		}
+		m_LayoutCache.for_each([&](const PipelineLayoutInfo &, VkPipelineLayout layout) {
+			vkDestroyPipelineLayout(m_Device, layout, nullptr);
+		});
+
+		m_LayoutCache.clear();
+	}
+
+	CacheStats PipelineLayoutCache::get_stats() const
+	{
+		return m_LayoutCache.get_stats();
 	}
 
 	bool PipelineLayoutCache::PipelineLayoutInfo::operator==(const PipelineLayoutInfo &other) const {
@@ -108,26 +122,38 @@ namespace vkutil {
 			if (other.m_Layouts[i] != m_Layouts[i]) return false;
 		}
 
+		if (other.m_PushConstants.size() != m_PushConstants.size()) return false;
+
+		for (uint32_t i = 0; i < m_PushConstants.size(); i++) {
+			if (other.m_PushConstants[i].stageFlags != m_PushConstants[i].stageFlags) return false;
+			if (other.m_PushConstants[i].offset != m_PushConstants[i].offset) return false;
+			if (other.m_PushConstants[i].size != m_PushConstants[i].size) return false;
+		}
+
 		return true;
 	}
 
 	size_t PipelineLayoutCache::PipelineLayoutInfo::hash() const {
-		using std::size_t;
-		using std::hash;
-
-		size_t result = hash<size_t>()(m_Layouts.size());
+		uint64_t result = hash_mix(m_Layouts.size());
 
 		for (const VkDescriptorSetLayout &l : m_Layouts) {
-			result ^= hash<size_t>()((uint64_t)l);
+			result = hash_combine(result, (uint64_t)l);
+		}
+
+		for (const VkPushConstantRange &r : m_PushConstants) {
+			result = hash_combine(result, r.stageFlags);
+			result = hash_combine(result, r.offset);
+			result = hash_combine(result, r.size);
 		}
 
-		return result;
+		return (size_t)result;
 	}
 
 	PipelineBuilder::PipelineBuilder(VulkanManager &manager)
 	{
 		m_Device = manager.device();
 		m_LayoutCache = &manager.get_pipeline_layout_cache();
+		m_PipelineCache = manager.get_pipeline_cache();
 		m_VertexInputInfo = vkinit::vertex_input_state_create_info();
 	}
 
@@ -143,6 +169,12 @@ namespace vkutil {
 		return *this;
 	}
 
+	PipelineBuilder &PipelineBuilder::add_shader_code(const std::vector<uint32_t> &code, VkShaderStageFlagBits shaderType)
+	{
+		m_ShaderCode.push_back({ shaderType, code });
+		return *this;
+	}
+
 	PipelineBuilder &PipelineBuilder::set_renderpass(VkRenderPass renderpass)
 	{
 		m_RenderPass = renderpass;
@@ -190,15 +222,67 @@ namespace vkutil {
 		return *this;
 	}
 
+	PipelineBuilder &PipelineBuilder::set_push_constants(std::vector<VkPushConstantRange> ranges)
+	{
+		m_PushConstants = ranges;
+		return *this;
+	}
+
+	PipelineBuilder &PipelineBuilder::set_specialization(const SpecializationConstants &constants)
+	{
+		m_Specialization = constants;
+		return *this;
+	}
+
+	void SpecializationConstants::add(uint32_t id, uint32_t value)
+	{
+		entries.push_back({ id, (uint32_t)(data.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+		data.push_back(value);
+	}
+
+	PipelineBuilder &PipelineBuilder::set_extended_dynamic_state(bool dynamicBlend)
+	{
+		m_ExtendedDynamicState = true;
+		m_DynamicBlend = dynamicBlend;
+		return *this;
+	}
+
+	VkSpecializationInfo SpecializationConstants::info() const
+	{
+		VkSpecializationInfo info{};
+		info.mapEntryCount = (uint32_t)entries.size();
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size() * sizeof(uint32_t);
+		info.pData = data.data();
+		return info;
+	}
+
 	bool PipelineBuilder::build(VkPipeline *pipeline, VkPipelineLayout *pipelineLayout)
 	{
 
 		VkPipelineLayoutCreateInfo layoutInfo = vkinit::pipeline_layout_create_info();
 		layoutInfo.pSetLayouts = m_DescriptorSetLayout.data();
 		layoutInfo.setLayoutCount = (uint32_t)m_DescriptorSetLayout.size();
+		layoutInfo.pPushConstantRanges = m_PushConstants.data();
+		layoutInfo.pushConstantRangeCount = (uint32_t)m_PushConstants.size();
 
 		VkPipelineLayout layout = m_LayoutCache->create_pipeline_layout(layoutInfo);
 
+		std::vector<VkPipelineShaderStageCreateInfo> stages = m_ShaderStageInfo;
+		std::vector<VkShaderModule> modules;
+
+		for (auto &[stage, code] : m_ShaderCode) {
+			VkShaderModule module{};
+			if (!compile_shader_module((uint32_t *)code.data(), (uint32_t)(code.size() * sizeof(uint32_t)), &module, m_Device)) {
+				CORE_WARN("PipelineBuilder: could not create shader module");
+				for (auto &m : modules) vkDestroyShaderModule(m_Device, m, nullptr);
+				return false;
+			}
+
+			modules.push_back(module);
+			stages.push_back(vkinit::pipeline_shader_stage_create_info(stage, module));
+		}
+
 		VkPipelineViewportStateCreateInfo viewportState{};
 		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 		viewportState.pNext = nullptr;
@@ -232,8 +316,13 @@ namespace vkutil {
 		createInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 		createInfo.pNext = &pipeline_create;
 
-		createInfo.stageCount = (uint32_t)m_ShaderStageInfo.size();
-		createInfo.pStages = m_ShaderStageInfo.data();
+		VkSpecializationInfo specializationInfo = m_Specialization.info();
+		for (auto &stage : stages) {
+			stage.pSpecializationInfo = m_Specialization.entries.empty() ? nullptr : &specializationInfo;
+		}
+
+		createInfo.stageCount = (uint32_t)stages.size();
+		createInfo.pStages = stages.data();
 		createInfo.pVertexInputState = &m_VertexInputInfo;
 		createInfo.pInputAssemblyState = &inputAssembly;
 		createInfo.pViewportState = &viewportState;
@@ -248,17 +337,32 @@ namespace vkutil {
 		if (m_EnableDepthStencil)
 			createInfo.pDepthStencilState = &m_DepthStencil;
 
+		std::vector<VkDynamicState> dynStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+		//core since 1.3, the baked values above are only used as the topology class
+		if (m_ExtendedDynamicState) {
+			dynStates.insert(dynStates.end(), {
+				VK_DYNAMIC_STATE_CULL_MODE, VK_DYNAMIC_STATE_FRONT_FACE,
+				VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY, VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE,
+				VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP });
+		}
+
+		if (m_DynamicBlend) {
+			dynStates.insert(dynStates.end(), { VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT, VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT });
+		}
+
 		VkPipelineDynamicStateCreateInfo dynStateInfo{};
-		VkDynamicState dynStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 		dynStateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
 		dynStateInfo.pNext = nullptr;
-		dynStateInfo.pDynamicStates = dynStates;
-		dynStateInfo.dynamicStateCount = 2;
+		dynStateInfo.pDynamicStates = dynStates.data();
+		dynStateInfo.dynamicStateCount = (uint32_t)dynStates.size();
 
 		createInfo.pDynamicState = &dynStateInfo;
 
 		*pipelineLayout = layout;
-		auto res = vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &createInfo, nullptr, pipeline);
+		auto res = vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &createInfo, nullptr, pipeline);
+
+		for (auto &module : modules) vkDestroyShaderModule(m_Device, module, nullptr);
 
 		return res == VK_SUCCESS;
 
@@ -272,32 +376,267 @@ namespace vkutil {
 
 	bool PipelineBuilder::build(Shader *shader)
 	{
+		shader->key = key();
 		return build(&shader->pipeline, &shader->layout);
 	}
 
-	void reflect(std::vector<uint32_t> buffer) {
+	void PipelineKey::add(uint64_t value)
+	{
+		words.push_back(value);
+		hash = hash_combine(hash, value);
+	}
+
+	void PipelineKey::add_bytes(const void *data, size_t size)
+	{
+		add(size);
+
+		const uint8_t *bytes = (const uint8_t *)data;
+		for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+			uint64_t word = 0;
+			std::memcpy(&word, bytes + i, std::min(sizeof(uint64_t), size - i));
+			add(word);
+		}
+	}
+
+	bool PipelineKey::operator==(const PipelineKey &other) const
+	{
+		return hash == other.hash && words == other.words;
+	}
+
+	static void add_layout_state(PipelineKey &key, const std::vector<VkDescriptorSetLayout> &layouts,
+		const std::vector<VkPushConstantRange> &pushConstants, const SpecializationConstants *specialization)
+	{
+		//set layouts come from the layout cache, so equal layouts have equal handles
+		key.add(layouts.size());
+		for (auto &l : layouts) key.add((uint64_t)l);
+
+		key.add(pushConstants.size());
+		for (auto &r : pushConstants) {
+			key.add(r.stageFlags);
+			key.add(r.offset);
+			key.add(r.size);
+		}
+
+		if (specialization) {
+			key.add(specialization->entries.size());
+			for (uint32_t i = 0; i < (uint32_t)specialization->entries.size(); i++) {
+				key.add(specialization->entries.at(i).constantID);
+				key.add(specialization->data.at(i));
+			}
+		}
+	}
+
+	PipelineKey PipelineBuilder::key() const
+	{
+		PipelineKey key;
+		key.add(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+		key.add(m_ShaderStageInfo.size());
+		for (auto &stage : m_ShaderStageInfo) {
+			key.add(stage.stage);
+			key.add((uint64_t)stage.module);
+		}
+
+		key.add(m_ShaderCode.size());
+		for (auto &[stage, code] : m_ShaderCode) {
+			key.add(stage);
+			key.add_bytes(code.data(), code.size() * sizeof(uint32_t));
+		}
+
+		key.add(m_VertexInputInfo.vertexBindingDescriptionCount);
+		for (uint32_t i = 0; i < m_VertexInputInfo.vertexBindingDescriptionCount; i++) {
+			const VkVertexInputBindingDescription &b = m_VertexInputInfo.pVertexBindingDescriptions[i];
+			key.add(b.binding);
+			key.add(b.stride);
+			key.add(b.inputRate);
+		}
+
+		key.add(m_VertexInputInfo.vertexAttributeDescriptionCount);
+		for (uint32_t i = 0; i < m_VertexInputInfo.vertexAttributeDescriptionCount; i++) {
+			const VkVertexInputAttributeDescription &a = m_VertexInputInfo.pVertexAttributeDescriptions[i];
+			key.add(a.location);
+			key.add(a.binding);
+			key.add(a.format);
+			key.add(a.offset);
+		}
+
+		key.add(m_ColorFormat);
+		key.add((uint64_t)m_RenderPass);
+
+		key.add(m_ExtendedDynamicState);
+		key.add(m_DynamicBlend);
 
-		spirv_cross::Compiler compiler(buffer);
+		key.add(m_EnableDepthStencil);
+		if (m_EnableDepthStencil) key.add(m_DepthFormat);
 
+		//dynamic depth state does not end up in the pipeline
+		if (m_EnableDepthStencil && !m_ExtendedDynamicState) {
+			key.add(m_DepthStencil.depthTestEnable);
+			key.add(m_DepthStencil.depthWriteEnable);
+			key.add(m_DepthStencil.depthCompareOp);
+		}
+
+		add_layout_state(key, m_DescriptorSetLayout, m_PushConstants, &m_Specialization);
+		return key;
+	}
+
+	PipelineKey compute_pipeline_key(const std::vector<uint32_t> &code, const std::vector<VkDescriptorSetLayout> &layouts,
+		const std::vector<VkPushConstantRange> &pushConstants, const SpecializationConstants *specialization)
+	{
+		PipelineKey key;
+		key.add(VK_PIPELINE_BIND_POINT_COMPUTE);
+		key.add_bytes(code.data(), code.size() * sizeof(uint32_t));
+
+		add_layout_state(key, layouts, pushConstants, specialization);
+		return key;
+	}
+
+	static VkFormat spirv_to_vk_format(const spirv_cross::SPIRType &type) {
+		if (type.width != 32 || type.vecsize < 1 || type.vecsize > 4) return VK_FORMAT_UNDEFINED;
+
+		static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+		static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+		static const VkFormat uintFormats[] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+		switch (type.basetype) {
+		case spirv_cross::SPIRType::Float: return floatFormats[type.vecsize - 1];
+		case spirv_cross::SPIRType::Int: return intFormats[type.vecsize - 1];
+		case spirv_cross::SPIRType::UInt: return uintFormats[type.vecsize - 1];
+		default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	bool reflect_shader_module(const std::vector<uint32_t> &code, VkShaderStageFlagBits stage, ShaderReflection *reflection,
+		const SpecializationConstants *specialization) {
+		if (code.empty()) return false;
+
+		spirv_cross::Compiler compiler(code);
 		spirv_cross::ShaderResources resources = compiler.get_shader_resources();
 
-		CORE_TRACE("{0} uniform buffers", resources.uniform_buffers.size());
-		CORE_TRACE("{0} resources", resources.sampled_images.size());
+		if (specialization) {
+			for (auto &constant : compiler.get_specialization_constants()) {
+				for (uint32_t i = 0; i < (uint32_t)specialization->entries.size(); i++) {
+					if (specialization->entries.at(i).constantID != constant.constant_id) continue;
+					compiler.get_constant(constant.id).m.c[0].r[0].u32 = specialization->data.at(i);
+				}
+			}
+		}
 
-		CORE_TRACE("Uniform buffers:");
-		for (const auto &resource : resources.uniform_buffers) {
-			const auto &bufferType = compiler.get_type(resource.base_type_id);
-			uint32_t bufferSize = (uint32_t)compiler.get_declared_struct_size(bufferType);
-			uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
-			uint32_t memberCount = (uint32_t)bufferType.member_types.size();
+		bool success = true;
+
+		auto addBindings = [&](const auto &list, VkDescriptorType type) {
+			for (const auto &resource : list) {
+				uint32_t set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+				uint32_t binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+				const spirv_cross::SPIRType &resourceType = compiler.get_type(resource.type_id);
+
+				//arrays sized by a specialization constant report the default value, runtime arrays count as one
+				uint32_t count = 1;
+				for (uint32_t i = 0; i < (uint32_t)resourceType.array.size(); i++) {
+					uint32_t size = resourceType.array_size_literal[i] ?
+						resourceType.array[i] : compiler.get_constant(resourceType.array[i]).scalar();
+					count *= std::max(size, 1u);
+				}
+
+				auto &bindings = reflection->sets[set];
+
+				auto it = std::find_if(bindings.begin(), bindings.end(),
+					[&](const VkDescriptorSetLayoutBinding &b) { return b.binding == binding; });
+
+				if (it == bindings.end()) {
+					bindings.push_back(vkinit::descriptorset_layout_binding(type, stage, binding));
+					bindings.back().descriptorCount = count;
+					continue;
+				}
+
+				if (it->descriptorType != type) {
+					CORE_WARN("Reflection: set {} binding {} is used with different descriptor types", set, binding);
+					success = false;
+				}
+
+				it->stageFlags |= stage;
+				it->descriptorCount = std::max(it->descriptorCount, count);
+			}
+		};
+
+		addBindings(resources.uniform_buffers, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+		addBindings(resources.storage_buffers, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		addBindings(resources.sampled_images, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+		addBindings(resources.separate_images, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
+		addBindings(resources.separate_samplers, VK_DESCRIPTOR_TYPE_SAMPLER);
+		addBindings(resources.storage_images, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+		addBindings(resources.subpass_inputs, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT);
+
+		for (auto &[set, bindings] : reflection->sets) {
+			std::sort(bindings.begin(), bindings.end(),
+				[](const VkDescriptorSetLayoutBinding &a, const VkDescriptorSetLayoutBinding &b) { return a.binding < b.binding; });
+		}
 
-			CORE_TRACE("  {0}", resource.name);
-			CORE_TRACE("    Size = {0}", bufferSize);
-			CORE_TRACE("    Binding = {0}", binding);
-			CORE_TRACE("    Members = {0}", memberCount);
+		for (const auto &resource : resources.push_constant_buffers) {
+			const spirv_cross::SPIRType &type = compiler.get_type(resource.base_type_id);
+
+			uint32_t begin = UINT32_MAX;
+			for (uint32_t i = 0; i < (uint32_t)type.member_types.size(); i++) {
+				begin = std::min(begin, compiler.type_struct_member_offset(type, i));
+			}
+
+			uint32_t end = (uint32_t)compiler.get_declared_struct_size(type);
+			if (begin >= end) continue;
+
+			if (reflection->pushConstants.empty()) {
+				reflection->pushConstants.push_back({ (VkShaderStageFlags)stage, begin, end - begin });
+				continue;
+			}
+
+			VkPushConstantRange &range = reflection->pushConstants.front();
+			uint32_t rangeEnd = std::max(range.offset + range.size, end);
+			range.offset = std::min(range.offset, begin);
+			range.size = rangeEnd - range.offset;
+			range.stageFlags |= stage;
 		}
 
+		if (stage == VK_SHADER_STAGE_VERTEX_BIT && reflection->vertexInput.attributes.empty()) {
+			std::vector<std::tuple<uint32_t, VkFormat, uint32_t>> inputs; //location, format, size
+
+			for (const auto &resource : resources.stage_inputs) {
+				const spirv_cross::SPIRType &type = compiler.get_type(resource.type_id);
+				uint32_t location = compiler.get_decoration(resource.id, spv::DecorationLocation);
+				VkFormat format = spirv_to_vk_format(type);
+
+				if (format == VK_FORMAT_UNDEFINED) {
+					CORE_WARN("Reflection: vertex input {} has an unsupported type", resource.name);
+					success = false;
+					continue;
+				}
+
+				//matrices take one location per column
+				for (uint32_t c = 0; c < type.columns; c++) inputs.push_back({ location + c, format, type.vecsize * 4 });
+			}
+
+			std::sort(inputs.begin(), inputs.end());
+
+			uint32_t offset = 0;
+			for (auto &[location, format, size] : inputs) {
+				VkVertexInputAttributeDescription attribute{};
+				attribute.binding = 0;
+				attribute.location = location;
+				attribute.format = format;
+				attribute.offset = offset;
+
+				reflection->vertexInput.attributes.push_back(attribute);
+				offset += size;
+			}
+
+			if (!inputs.empty()) {
+				VkVertexInputBindingDescription binding{};
+				binding.binding = 0;
+				binding.stride = offset;
+				binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+				reflection->vertexInput.bindings.push_back(binding);
+			}
+		}
 
+		return success;
 	}
 
 	bool compile_shader_module(uint32_t *buffer, uint32_t byteSize,
@@ -345,9 +684,72 @@ namespace vkutil {
 		return true;
 	}
 
+	static constexpr uint32_t SPIRV_CACHE_VERSION = 1;
+	static const char *SPIRV_CACHE_DIRECTORY = "cache/shaders";
+
+	//the preprocessed source already has the defines applied and every include expanded, so a change to either of
+	//them or to where an include is found gives a new key
+	static uint64_t spirv_cache_key(const std::string &preprocessed, shaderc_shader_kind kind, bool optimize) {
+		unsigned int spvVersion = 0, spvRevision = 0;
+		shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+		uint64_t key = hash_mix(SPIRV_CACHE_VERSION);
+		key = hash_combine(key, spvVersion);
+		key = hash_combine(key, spvRevision);
+		key = hash_combine(key, shaderc_env_version_vulkan_1_1);
+		key = hash_combine(key, kind);
+		key = hash_combine(key, optimize);
+
+		return hash_bytes(preprocessed.data(), preprocessed.size(), key);
+	}
+
+	static std::filesystem::path spirv_cache_path(uint64_t key) {
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.spv", (unsigned long long)key);
+		return std::filesystem::path(SPIRV_CACHE_DIRECTORY) / name;
+	}
+
+	static bool load_cached_spirv(uint64_t key, std::vector<uint32_t> *code) {
+		std::ifstream file(spirv_cache_path(key), std::ios::ate | std::ios::binary);
+		if (!file.is_open()) return false;
+
+		size_t fileSize = (size_t)file.tellg();
+		if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0) return false;
+
+		code->resize(fileSize / sizeof(uint32_t));
+		file.seekg(0);
+		file.read((char *)code->data(), fileSize);
+
+		//reject anything that is not a complete SPIR-V module
+		return file.good() && code->at(0) == 0x07230203;
+	}
+
+	static void store_cached_spirv(uint64_t key, const std::vector<uint32_t> &code) {
+		std::error_code ec;
+		std::filesystem::create_directories(SPIRV_CACHE_DIRECTORY, ec);
+
+		//shaders can be compiled on several threads at once, every writer gets its own temporary file
+		std::filesystem::path path = spirv_cache_path(key);
+		std::filesystem::path tmpPath = path;
+		tmpPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) {
+				CORE_WARN("Could not write shader cache: {}", tmpPath.string());
+				return;
+			}
+
+			file.write((const char *)code.data(), code.size() * sizeof(uint32_t));
+		}
+
+		std::filesystem::rename(tmpPath, path, ec);
+		if (ec) CORE_WARN("Could not write shader cache: {}", ec.message());
+	}
+
 	std::vector<uint32_t> compile_glsl_to_spirv(const std::string &source_name,
 		VkShaderStageFlagBits stage, const char *source, size_t sourceSize,
-		bool optimize)
+		bool optimize, const std::vector<std::pair<std::string, std::string>> &defines)
 	{
 
 		shaderc_shader_kind kind{};
@@ -377,6 +779,8 @@ namespace vkutil {
 
 		if (optimize) options.SetOptimizationLevel(shaderc_optimization_level_size);
 
+		for (auto &[name, value] : defines) options.AddMacroDefinition(name, value);
+
 		shaderc::PreprocessedSourceCompilationResult preRes =
 			compiler.PreprocessGlsl(source, sourceSize, kind, source_name.c_str(), options);
 
@@ -384,16 +788,25 @@ namespace vkutil {
 			CORE_WARN("Preprocess failed for file: {}\n{}", source, preRes.GetErrorMessage());
 		}
 
-		std::string prePassedSource(preRes.begin());
+		std::string prePassedSource(preRes.cbegin(), preRes.cend());
+
+		uint64_t cacheKey = spirv_cache_key(prePassedSource, kind, optimize);
+
+		std::vector<uint32_t> cached;
+		if (load_cached_spirv(cacheKey, &cached)) return cached;
 
 		shaderc::SpvCompilationResult module =
 			compiler.CompileGlslToSpv(source, sourceSize, kind, source_name.c_str(), options);
 
 		if (module.GetCompilationStatus() != shaderc_compilation_status_success) {
 			CORE_WARN(module.GetErrorMessage());
+			return { module.cbegin(), module.cend() };
 		}
 
-		return { module.cbegin(), module.cend() };
+		std::vector<uint32_t> code(module.cbegin(), module.cend());
+		store_cached_spirv(cacheKey, code);
+
+		return code;
 	}
 
 	bool load_glsl_shader_module(const VulkanManager &manager, std::filesystem::path filePath,
@@ -465,11 +878,14 @@ namespace vkutil {
 		return load_glsl_shader_module(manager, filePath, type, outShaderModule);
 	}
 
-	void create_compute_shader(VulkanManager &manager, VkShaderModule module, std::vector<VkDescriptorSetLayout> layouts, VkPipeline *pipeline, VkPipelineLayout *pipelineLayout) {
+	void create_compute_shader(VulkanManager &manager, VkShaderModule module, std::vector<VkDescriptorSetLayout> layouts, VkPipeline *pipeline, VkPipelineLayout *pipelineLayout,
+		std::vector<VkPushConstantRange> pushConstants, const SpecializationConstants *specialization) {
 
 		VkPipelineLayoutCreateInfo layoutInfo = vkinit::pipeline_layout_create_info();
 		layoutInfo.pSetLayouts = layouts.data();
 		layoutInfo.setLayoutCount = (uint32_t)layouts.size();
+		layoutInfo.pPushConstantRanges = pushConstants.data();
+		layoutInfo.pushConstantRangeCount = (uint32_t)pushConstants.size();
 
 		VkPipelineLayout layout = manager.get_pipeline_layout_cache().create_pipeline_layout(layoutInfo);
 		*pipelineLayout = layout;
@@ -482,7 +898,13 @@ namespace vkutil {
 		info.stage.pName = "main";
 		info.layout = layout;
 
-		VK_CHECK(vkCreateComputePipelines(manager.device(), VK_NULL_HANDLE, 1, &info, nullptr, pipeline));
+		VkSpecializationInfo specializationInfo{};
+		if (specialization && !specialization->entries.empty()) {
+			specializationInfo = specialization->info();
+			info.stage.pSpecializationInfo = &specializationInfo;
+		}
+
+		VK_CHECK(vkCreateComputePipelines(manager.device(), manager.get_pipeline_cache(), 1, &info, nullptr, pipeline));
 	}
 
 
@@ -2,6 +2,7 @@
 
 #include "vk_types.h"
 #include "vk_initializers.h"
+#include "vk_cache.h"
 
 #include <glm/glm.hpp>
 
@@ -62,24 +63,65 @@ namespace vkutil {
 
 	};
 
+	//the pipeline state as plain words. pipelines are looked up by the hash and compared word by word,
+	//so a hash collision never hands out the pipeline of another state
+	struct PipelineKey {
+		std::vector<uint64_t> words;
+		uint64_t hash{ 0 };
+
+		void add(uint64_t value);
+		void add_bytes(const void *data, size_t size);
+
+		bool operator==(const PipelineKey &other) const;
+	};
+
 	struct Shader {
 		VkPipelineLayout layout;
 		VkPipeline pipeline;
+		PipelineKey key; //identical states share one pipeline
+		std::vector<VkPushConstantRange> pushConstants;
+		VkPipelineBindPoint bindPoint{ VK_PIPELINE_BIND_POINT_GRAPHICS };
 	};
 
+	//32 bit specialization constants, the value holds the bit pattern of an int, uint, bool or float
+	struct SpecializationConstants {
+		std::vector<VkSpecializationMapEntry> entries;
+		std::vector<uint32_t> data;
+
+		void add(uint32_t id, uint32_t value);
+		VkSpecializationInfo info() const;
+	};
+
+	struct ShaderReflection {
+		//keyed by the set number of the shader, sets it does not use are missing
+		std::map<uint32_t, std::vector<VkDescriptorSetLayoutBinding>> sets;
+		//all stages share a single range, so one vkCmdPushConstants call covers every stage
+		std::vector<VkPushConstantRange> pushConstants;
+		//vertex inputs ordered by location and tightly packed into binding 0
+		VertexInputDescription vertexInput;
+	};
+
+	//adds the resources used by the module to the reflection, can be called once per stage of a shader
+	//specialization values replace the defaults, so arrays sized by a constant report their specialized size
+	bool reflect_shader_module(const std::vector<uint32_t> &code, VkShaderStageFlagBits stage, ShaderReflection *reflection,
+		const SpecializationConstants *specialization = nullptr);
+
 	class PipelineLayoutCache {
 	public:
 
 		PipelineLayoutCache() = default;
-		PipelineLayoutCache(VkDevice device)
-			: m_Device(device) {}
+
+		void init(VkDevice device);
 
 		VkPipelineLayout create_pipeline_layout(VkPipelineLayoutCreateInfo &info);
 
 		void cleanup();
 
+		CacheStats get_stats() const;
+
 		struct PipelineLayoutInfo {
 			std::vector<VkDescriptorSetLayout> m_Layouts;
+			std::vector<VkPushConstantRange> m_PushConstants;
 
 			bool operator==(const PipelineLayoutInfo &other) const;
 
@@ -95,7 +137,7 @@ namespace vkutil {
 		};
 
 		VkDevice m_Device{ VK_NULL_HANDLE };
-		std::unordered_map<PipelineLayoutInfo, VkPipelineLayout, PipelineLayoutHash> m_LayoutCache;
+		ShardedCache<PipelineLayoutInfo, VkPipelineLayout, PipelineLayoutHash> m_LayoutCache;
 
 	};
 
@@ -107,6 +149,8 @@ namespace vkutil {
 		PipelineBuilder &set_color_format(VkFormat format);
 
 		PipelineBuilder &add_shader_module(VkShaderModule shaderModule, VkShaderStageFlagBits shaderType);
+		//the module is only created inside build, so the code can be part of the state hash
+		PipelineBuilder &add_shader_code(const std::vector<uint32_t> &code, VkShaderStageFlagBits shaderType);
 
 		PipelineBuilder &set_renderpass(VkRenderPass renderpass);
 
@@ -120,29 +164,45 @@ namespace vkutil {
 		PipelineBuilder &set_depth_stencil(bool depthTest, bool depthWrite, VkCompareOp compareOp, VkFormat depthFormat);
 
 		PipelineBuilder &set_descriptor_layouts(std::vector<VkDescriptorSetLayout> layouts);
+		PipelineBuilder &set_push_constants(std::vector<VkPushConstantRange> ranges);
+		//applied to every stage, constants a stage does not declare are ignored
+		PipelineBuilder &set_specialization(const SpecializationConstants &constants);
+		//cull mode, front face, topology and depth test / write / compare are left to the command buffer,
+		//dynamicBlend also leaves blend enable and equation to it (needs VK_EXT_extended_dynamic_state3)
+		PipelineBuilder &set_extended_dynamic_state(bool dynamicBlend = false);
 
 		bool build(VkPipeline *pipeline, VkPipelineLayout *layout);
 		bool build(VkPipeline *pipeline);
 		bool build(Shader *shader);
 
+		//everything that ends up in the pipeline, modules added by handle are keyed by handle
+		PipelineKey key() const;
+
 	private:
 
 		VkDevice m_Device{ VK_NULL_HANDLE };
 		VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
 
 		PipelineLayoutCache *m_LayoutCache{ nullptr };
+		VkPipelineCache m_PipelineCache{ VK_NULL_HANDLE };
 
-		VkFormat m_ColorFormat;
-		VkFormat m_DepthFormat;
+		VkFormat m_ColorFormat{ VK_FORMAT_UNDEFINED };
+		VkFormat m_DepthFormat{ VK_FORMAT_UNDEFINED };
 
 		std::vector<VkPipelineShaderStageCreateInfo> m_ShaderStageInfo;
+		std::vector<std::pair<VkShaderStageFlagBits, std::vector<uint32_t>>> m_ShaderCode;
 		VkPipelineVertexInputStateCreateInfo m_VertexInputInfo{};
 
 		std::vector<VkDescriptorSetLayout> m_DescriptorSetLayout;
+		std::vector<VkPushConstantRange> m_PushConstants;
+		SpecializationConstants m_Specialization;
 
 		bool m_EnableDepthStencil = false;
 		VkPipelineDepthStencilStateCreateInfo m_DepthStencil{};
 
+		bool m_ExtendedDynamicState = false;
+		bool m_DynamicBlend = false;
+
 	};
 
 	bool compile_shader_module(uint32_t *buffer, uint32_t byteSize,
@@ -151,7 +211,7 @@ namespace vkutil {
 
 	std::vector<uint32_t> compile_glsl_to_spirv(const std::string &source_name,
 		VkShaderStageFlagBits stage, const char *source, size_t sourceSize,
-		bool optimize = false);
+		bool optimize = false, const std::vector<std::pair<std::string, std::string>> &defines = {});
 
 	bool load_spirv_shader_module(const char *filePath,
 		VkShaderModule *outShaderModule,
@@ -163,5 +223,9 @@ namespace vkutil {
 
 	bool load_glsl_shader_module(const VulkanManager &manager, std::filesystem::path filePath, VkShaderModule *outShaderModule);
 
-	void create_compute_shader(VulkanManager &manager, VkShaderModule module, std::vector<VkDescriptorSetLayout> layouts, VkPipeline *pipeline, VkPipelineLayout *pipelineLayout);
+	PipelineKey compute_pipeline_key(const std::vector<uint32_t> &code, const std::vector<VkDescriptorSetLayout> &layouts,
+		const std::vector<VkPushConstantRange> &pushConstants, const SpecializationConstants *specialization);
+
+	void create_compute_shader(VulkanManager &manager, VkShaderModule module, std::vector<VkDescriptorSetLayout> layouts, VkPipeline *pipeline, VkPipelineLayout *pipelineLayout,
+		std::vector<VkPushConstantRange> pushConstants = {}, const SpecializationConstants *specialization = nullptr);
 } //namespace vkutil
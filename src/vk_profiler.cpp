@@ -0,0 +1,207 @@
+#include "vk_profiler.h"
+
+#include "vk_manager.h"
+
+namespace vkutil {
+
+	//with one frame in flight the results are ready long before a pool is reused, more frames never wait either
+	static const uint32_t c_ProfilerFrames = 3;
+	static const uint32_t c_MaxQueries = 256;
+	static const size_t c_HistorySize = 100;
+
+	//queries 0 and 1 time the whole frame
+	static const uint32_t c_FrameQueries = 2;
+
+	void GpuProfiler::init(VulkanManager &manager, uint32_t queueFamily)
+	{
+		m_Manager = &manager;
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(manager.get_physical_device(), &properties);
+
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(manager.get_physical_device(), &familyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(manager.get_physical_device(), &familyCount, families.data());
+
+		uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+		if (validBits == 0) {
+			CORE_WARN("GpuProfiler: the graphics queue does not support timestamps");
+			return;
+		}
+
+		m_Supported = true;
+		m_TimestampPeriod = properties.limits.timestampPeriod;
+		m_TimestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount = c_MaxQueries;
+
+		m_Frames.resize(c_ProfilerFrames);
+		for (auto &frame : m_Frames) VK_CHECK(vkCreateQueryPool(manager.device(), &poolInfo, nullptr, &frame.pool));
+	}
+
+	void GpuProfiler::cleanup()
+	{
+		for (auto &frame : m_Frames) vkDestroyQueryPool(m_Manager->device(), frame.pool, nullptr);
+		m_Frames.clear();
+	}
+
+	void GpuProfiler::begin_frame(VkCommandBuffer cmd)
+	{
+		if (!m_Supported) return;
+
+		m_FrameIndex = (m_FrameIndex + 1) % c_ProfilerFrames;
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+
+		resolve(frame);
+
+		frame.scopes.clear();
+		frame.queryCount = c_FrameQueries;
+		frame.recorded = false;
+		m_Depth = 0;
+		m_Recording = true;
+
+		vkCmdResetQueryPool(cmd, frame.pool, 0, c_MaxQueries);
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, 0);
+	}
+
+	void GpuProfiler::end_frame(VkCommandBuffer cmd)
+	{
+		if (!m_Recording) return;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		if (m_Depth > 0) CORE_WARN("GpuProfiler: {} scopes were never ended", m_Depth);
+
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.pool, 1);
+		frame.recorded = true;
+		m_Recording = false;
+	}
+
+	uint32_t GpuProfiler::begin_scope(VkCommandBuffer cmd, const char *name)
+	{
+		if (!m_Recording) return UINT32_MAX;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		if (frame.queryCount + 2 > c_MaxQueries) {
+			if (frame.queryCount != c_MaxQueries) CORE_WARN("GpuProfiler: more than {} scopes in a frame", (c_MaxQueries - c_FrameQueries) / 2);
+			frame.queryCount = c_MaxQueries;
+			return UINT32_MAX;
+		}
+
+		uint32_t scope = (uint32_t)frame.scopes.size();
+		frame.scopes.push_back({ name, m_Depth, frame.queryCount });
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, frame.queryCount);
+
+		frame.queryCount += 2;
+		m_Depth++;
+
+		return scope;
+	}
+
+	void GpuProfiler::end_scope(VkCommandBuffer cmd, uint32_t scope)
+	{
+		if (!m_Recording || scope == UINT32_MAX) return;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		CORE_ASSERT(scope < frame.scopes.size(), "GpuProfiler: scope was begun in another frame");
+
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.pool, frame.scopes[scope].query + 1);
+		m_Depth--;
+	}
+
+	bool GpuProfiler::is_supported() const
+	{
+		return m_Supported;
+	}
+
+	const std::vector<GpuScopeTiming> &GpuProfiler::get_timings() const
+	{
+		return m_Timings;
+	}
+
+	float GpuProfiler::get_frame_time() const
+	{
+		return m_FrameTime;
+	}
+
+	const std::vector<float> &GpuProfiler::get_frame_history() const
+	{
+		return m_FrameHistory;
+	}
+
+	const std::vector<GpuScopeHistory> &GpuProfiler::get_history() const
+	{
+		return m_History;
+	}
+
+	void GpuProfiler::resolve(QueryFrame &frame)
+	{
+		if (!frame.recorded) return;
+		frame.recorded = false;
+
+		//value and availability of every query, VK_NOT_READY only means some of them are not available
+		std::vector<uint64_t> results(frame.queryCount * 2);
+		VkResult result = vkGetQueryPoolResults(m_Manager->device(), frame.pool, 0, frame.queryCount,
+			results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		if (result != VK_SUCCESS && result != VK_NOT_READY) {
+			CORE_WARN("GpuProfiler: could not read the timestamps, {}", result);
+			return;
+		}
+
+		auto elapsed = [&](uint32_t query, float *ms) {
+			if (!results[query * 2 + 1] || !results[query * 2 + 3]) return false;
+
+			uint64_t ticks = (results[query * 2 + 2] - results[query * 2]) & m_TimestampMask;
+			*ms = (float)((double)ticks * m_TimestampPeriod / 1000000.0);
+			return true;
+		};
+
+		float frameMs;
+		if (!elapsed(0, &frameMs)) return;
+
+		m_FrameTime = frameMs;
+		m_Timings.clear();
+
+		for (auto &scope : frame.scopes) {
+			float ms;
+			if (elapsed(scope.query, &ms)) m_Timings.push_back({ scope.name, scope.depth, ms });
+		}
+
+		push_history(frameMs);
+	}
+
+	void GpuProfiler::push_history(float frameMs)
+	{
+		m_FrameHistory.push_back(frameMs);
+		for (auto &history : m_History) history.ms.push_back(0.0f);
+
+		for (auto &timing : m_Timings) {
+			if (timing.depth > 0) continue;
+
+			auto it = std::find_if(m_History.begin(), m_History.end(), [&](const GpuScopeHistory &h) { return h.name == timing.name; });
+			if (it == m_History.end()) {
+				m_History.push_back({ timing.name, std::vector<float>(m_FrameHistory.size(), 0.0f) });
+				it = m_History.end() - 1;
+			}
+
+			//a pass recorded more than once per frame adds up
+			it->ms.back() += timing.ms;
+		}
+
+		if (m_FrameHistory.size() > c_HistorySize) {
+			m_FrameHistory.erase(m_FrameHistory.begin());
+			for (auto &history : m_History) history.ms.erase(history.ms.begin());
+		}
+
+		//scopes that were not recorded for the whole history are dropped
+		m_History.erase(std::remove_if(m_History.begin(), m_History.end(), [](const GpuScopeHistory &h) {
+			return std::all_of(h.ms.begin(), h.ms.end(), [](float ms) { return ms == 0.0f; });
+		}), m_History.end());
+	}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+
+	struct GpuScopeTiming {
+		const char *name;
+		uint32_t depth; //0 for scopes that are not nested in another one
+		float ms;
+	};
+
+	//gpu time of a top level scope over the last frames, every history has one value per frame
+	struct GpuScopeHistory {
+		std::string name;
+		std::vector<float> ms;
+	};
+
+	// timestamp queries around scopes of the graphics work. every frame writes into its own query pool of a small
+	// ring, the results of a pool are read without waiting when the pool is reused, a few frames after it was submitted
+	class GpuProfiler {
+	public:
+
+		void init(VulkanManager &manager, uint32_t queueFamily);
+		void cleanup();
+
+		//reset the queries of the frame and start its timing, outside of a render pass
+		void begin_frame(VkCommandBuffer cmd);
+		void end_frame(VkCommandBuffer cmd);
+
+		//name has to live until the frame is resolved, e.g. a string literal. returns UINT32_MAX if nothing was recorded
+		uint32_t begin_scope(VkCommandBuffer cmd, const char *name);
+		void end_scope(VkCommandBuffer cmd, uint32_t scope);
+
+		bool is_supported() const;
+		//the newest resolved frame, nested scopes follow their parent
+		const std::vector<GpuScopeTiming> &get_timings() const;
+		float get_frame_time() const;
+		const std::vector<float> &get_frame_history() const;
+		const std::vector<GpuScopeHistory> &get_history() const;
+
+	private:
+
+		struct ScopeQuery {
+			const char *name;
+			uint32_t depth;
+			uint32_t query; //the begin query, the end query follows it
+		};
+
+		struct QueryFrame {
+			VkQueryPool pool{ VK_NULL_HANDLE };
+			std::vector<ScopeQuery> scopes;
+			uint32_t queryCount{ 0 };
+			bool recorded{ false };
+		};
+
+		void resolve(QueryFrame &frame);
+		void push_history(float frameMs);
+
+		VulkanManager *m_Manager{ nullptr };
+
+		bool m_Supported{ false };
+		float m_TimestampPeriod{ 1.0f }; //nanoseconds per tick
+		uint64_t m_TimestampMask{ 0 };
+
+		std::vector<QueryFrame> m_Frames;
+		uint32_t m_FrameIndex{ 0 };
+		uint32_t m_Depth{ 0 };
+		bool m_Recording{ false };
+
+		std::vector<GpuScopeTiming> m_Timings;
+		float m_FrameTime{ 0 };
+		std::vector<float> m_FrameHistory;
+		std::vector<GpuScopeHistory> m_History;
+	};
+
+}
@@ -0,0 +1,210 @@
+#include "vk_readback.h"
+
+#include "vk_manager.h"
+#include "vk_initializers.h"
+#include "ktx2.h"
+
+namespace vkutil {
+
+	static const VkDeviceSize c_InitialRingSize = 4 * 1024 * 1024;
+	//image copies need offsets that are a multiple of the texel size and of 4
+	static const VkDeviceSize c_RingAlignment = 16;
+
+	//makes the writes of everything recorded before visible to the copy
+	static void barrier_before_copy(VkCommandBuffer cmd)
+	{
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	static void barrier_to_host(VkCommandBuffer cmd)
+	{
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+			1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	void ReadbackRing::init(VulkanManager &manager)
+	{
+		m_Manager = &manager;
+		create_block(c_InitialRingSize);
+	}
+
+	void ReadbackRing::cleanup()
+	{
+		//readbacks of a frame that was never submitted end with a broken promise
+		m_Pending.clear();
+
+		for (auto &block : m_Retired) destroy_block(block);
+		m_Retired.clear();
+
+		destroy_block(m_Block);
+	}
+
+	std::future<ReadbackData> ReadbackRing::read_buffer(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (size == 0) return empty();
+
+		VkDeviceSize ringOffset = allocate(size);
+
+		barrier_before_copy(cmd);
+
+		VkBufferCopy copy{};
+		copy.srcOffset = offset;
+		copy.dstOffset = ringOffset;
+		copy.size = size;
+		vkCmdCopyBuffer(cmd, buffer, m_Block.buffer.buffer, 1, &copy);
+
+		barrier_to_host(cmd);
+
+		Readback &readback = m_Pending.emplace_back();
+		readback.allocation = m_Block.buffer.allocation;
+		readback.data = m_Block.mapped + ringOffset;
+		readback.offset = ringOffset;
+		readback.size = size;
+		return readback.promise.get_future();
+	}
+
+	std::future<ReadbackData> ReadbackRing::read_texture(VkCommandBuffer cmd, VkTexture &tex, const VkRect2D &region)
+	{
+		if (tex.transient) {
+			CORE_WARN("ReadbackRing: transient attachments are not stored, they can not be read back");
+			return empty();
+		}
+
+		FormatBlockInfo block;
+		if (!format_block_info(tex.format, &block) || block.width > 1) {
+			CORE_WARN("ReadbackRing: can not read back textures of format {}", tex.format);
+			return empty();
+		}
+
+		if (region.offset.x < 0 || region.offset.y < 0
+			|| region.offset.x + region.extent.width > tex.width || region.offset.y + region.extent.height > tex.height) {
+			CORE_WARN("ReadbackRing: region ({}, {}, {}, {}) is outside of the {}x{} texture", region.offset.x, region.offset.y,
+				region.extent.width, region.extent.height, tex.width, tex.height);
+			return empty();
+		}
+
+		VkDeviceSize size = (VkDeviceSize)region.extent.width * region.extent.height * block.bytes;
+		if (size == 0) return empty();
+
+		VkDeviceSize ringOffset = allocate(size);
+
+		VkImageSubresourceRange range{};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.levelCount = 1;
+		range.layerCount = 1;
+
+		insert_image_memory_barrier(cmd, tex.imageAllocation.image,
+			VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			tex.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			range);
+
+		VkBufferImageCopy copy{};
+		copy.bufferOffset = ringOffset;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = { region.offset.x, region.offset.y, 0 };
+		copy.imageExtent = { region.extent.width, region.extent.height, 1 };
+
+		vkCmdCopyImageToBuffer(cmd, tex.imageAllocation.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Block.buffer.buffer, 1, &copy);
+
+		insert_image_memory_barrier(cmd, tex.imageAllocation.image,
+			0, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, tex.layout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			range);
+
+		barrier_to_host(cmd);
+
+		Readback &readback = m_Pending.emplace_back();
+		readback.allocation = m_Block.buffer.allocation;
+		readback.data = m_Block.mapped + ringOffset;
+		readback.offset = ringOffset;
+		readback.size = size;
+		return readback.promise.get_future();
+	}
+
+	void ReadbackRing::resolve()
+	{
+		if (m_Pending.empty()) return;
+
+		ATL_EVENT();
+
+		for (auto &readback : m_Pending) {
+			//host cached memory does not have to be coherent
+			vmaInvalidateAllocation(m_Manager->get_allocator(), readback.allocation, readback.offset, readback.size);
+			readback.promise.set_value(ReadbackData(readback.data, readback.data + readback.size));
+		}
+
+		m_Pending.clear();
+
+		for (auto &block : m_Retired) destroy_block(block);
+		m_Retired.clear();
+
+		m_Offset = 0;
+	}
+
+	std::future<ReadbackData> ReadbackRing::empty()
+	{
+		std::promise<ReadbackData> promise;
+		promise.set_value({});
+		return promise.get_future();
+	}
+
+	VkDeviceSize ReadbackRing::allocate(VkDeviceSize size)
+	{
+		VkDeviceSize offset = (m_Offset + c_RingAlignment - 1) / c_RingAlignment * c_RingAlignment;
+
+		if (offset + size > m_Block.capacity) {
+			m_Retired.push_back(m_Block);
+			create_block(std::max(m_Block.capacity * 2, size));
+			offset = 0;
+		}
+
+		m_Offset = offset + size;
+		return offset;
+	}
+
+	void ReadbackRing::create_block(VkDeviceSize capacity)
+	{
+		VkBufferCreateInfo bufferInfo{};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = capacity;
+		bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+		//cached memory makes reading it on the cpu fast, uncached memory is read a lot slower
+		VmaAllocationCreateInfo allocInfo{};
+		allocInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		allocInfo.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+		m_Block = {};
+		VK_CHECK(vmaCreateBuffer(m_Manager->get_allocator(), &bufferInfo, &allocInfo,
+			&m_Block.buffer.buffer, &m_Block.buffer.allocation, nullptr));
+
+		void *mapped;
+		VK_CHECK(vmaMapMemory(m_Manager->get_allocator(), m_Block.buffer.allocation, &mapped));
+		m_Block.mapped = (uint8_t *)mapped;
+		m_Block.capacity = capacity;
+	}
+
+	void ReadbackRing::destroy_block(StagingBlock &block)
+	{
+		if (!block.buffer.buffer) return;
+
+		vmaUnmapMemory(m_Manager->get_allocator(), block.buffer.allocation);
+		destroy_buffer(*m_Manager, block.buffer);
+		block = {};
+	}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+
+	using ReadbackData = std::vector<uint8_t>;
+
+	// copies gpu data into host cached memory without waiting on the gpu. the copies are recorded into the frame's
+	// command buffer, the futures resolve once the frame fence signalled. with a single frame in flight the ring is
+	// rewound every frame and only grows if a frame reads back more than it holds
+	class ReadbackRing {
+	public:
+
+		void init(VulkanManager &manager);
+		void cleanup();
+
+		std::future<ReadbackData> read_buffer(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+		//tightly packed rows of level 0, only uncompressed color formats
+		std::future<ReadbackData> read_texture(VkCommandBuffer cmd, VkTexture &tex, const VkRect2D &region);
+
+		//called after the fence of the frame the copies were recorded in
+		void resolve();
+
+		//a future that is already resolved with no data, for reads that could not be recorded
+		static std::future<ReadbackData> empty();
+
+	private:
+
+		struct StagingBlock {
+			AllocatedBuffer buffer;
+			uint8_t *mapped;
+			VkDeviceSize capacity;
+		};
+
+		struct Readback {
+			VmaAllocation allocation;
+			const uint8_t *data;
+			VkDeviceSize offset, size;
+			std::promise<ReadbackData> promise;
+		};
+
+		//returns the offset into the current block, a larger block is started if it is full
+		VkDeviceSize allocate(VkDeviceSize size);
+		void create_block(VkDeviceSize capacity);
+		void destroy_block(StagingBlock &block);
+
+		VulkanManager *m_Manager{ nullptr };
+
+		StagingBlock m_Block{};
+		VkDeviceSize m_Offset{ 0 };
+		//outgrown blocks, readbacks of the frame still point into them
+		std::vector<StagingBlock> m_Retired;
+
+		std::vector<Readback> m_Pending;
+	};
+
+}
@@ -0,0 +1,391 @@
+#include "vk_residency.h"
+
+#include "vk_manager.h"
+#include "vk_initializers.h"
+#include "vk_texture_streamer.h"
+#include "ktx2.h"
+
+#include "imgui_impl_vulkan.h"
+
+namespace vkutil {
+
+	//share of the device local heaps the streamed textures may use when no budget was set
+	static const double c_DefaultBudgetFraction = 0.5;
+	//mips are only streamed back in below this share of the budget, so textures don't thrash at the limit
+	static const double c_StreamInThreshold = 0.9;
+	//a texture counts as on screen if it was used within this many frames
+	static const uint64_t c_RecentFrames = 2;
+	//evictions never shrink a texture below this size on its largest side
+	static const uint32_t c_MinResidentSize = 64;
+	static const uint32_t c_MaxTransitionsPerFrame = 4;
+
+	void ResidencyManager::init(VulkanManager &manager, TextureStreamer &streamer, VkQueue graphicsQueue, uint32_t graphicsFamily)
+	{
+		m_Manager = &manager;
+		m_Streamer = &streamer;
+		m_GraphicsQueue = graphicsQueue;
+
+		VkCommandPoolCreateInfo poolInfo = vkinit::command_pool_create_info(graphicsFamily,
+			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		VK_CHECK(vkCreateCommandPool(manager.device(), &poolInfo, nullptr, &m_CommandPool));
+	}
+
+	void ResidencyManager::cleanup()
+	{
+		VkDevice device = m_Manager->device();
+
+		//the device is idle, images of unfinished transitions were never swapped in
+		for (auto &eviction : m_PendingEvictions) {
+			vmaDestroyImage(m_Manager->get_allocator(), eviction.image.image, eviction.image.allocation);
+			vkDestroyFence(device, eviction.fence, nullptr);
+		}
+
+		for (auto &streamIn : m_PendingStreamIns) {
+			if (streamIn.request->state != TextureRequest::State::Resident) continue;
+
+			AllocatedImage &image = streamIn.request->texture.imageAllocation;
+			vmaDestroyImage(m_Manager->get_allocator(), image.image, image.allocation);
+		}
+
+		m_PendingEvictions.clear();
+		m_PendingStreamIns.clear();
+		m_Textures.clear();
+
+		vkDestroyCommandPool(device, m_CommandPool, nullptr);
+	}
+
+	Ref<ResidentTexture> ResidencyManager::track(const TextureRequest &request, WeakRef<VkTexture> texture)
+	{
+		if (request.mipLevels <= 1) return nullptr;
+
+		Ref<ResidentTexture> result = make_ref<ResidentTexture>();
+		result->texture = texture;
+		result->path = request.path;
+		result->samplerInfo = request.samplerInfo;
+		result->mipmaps = request.mipmaps;
+		result->format = request.format;
+		result->width = request.width;
+		result->height = request.height;
+		result->mipLevels = request.mipLevels;
+		result->lastUsedFrame = m_Frame;
+
+		m_Textures.push_back(result);
+		return result;
+	}
+
+	void ResidencyManager::mark_used(ResidentTexture &texture, float screenSize)
+	{
+		uint32_t level = 0;
+
+		if (screenSize > 0.0f) {
+			float ratio = (float)std::max(texture.width, texture.height) / screenSize;
+			if (ratio > 1.0f) level = (uint32_t)std::floor(std::log2(ratio));
+		}
+
+		level = std::min(level, texture.mipLevels - 1);
+
+		//the largest use of the frame decides
+		if (texture.lastUsedFrame != m_Frame) texture.desiredLevel = level;
+		else texture.desiredLevel = std::min(texture.desiredLevel, level);
+
+		texture.lastUsedFrame = m_Frame;
+	}
+
+	void ResidencyManager::set_budget(uint64_t bytes)
+	{
+		m_Budget = bytes;
+	}
+
+	ResidencyStats ResidencyManager::get_stats() const
+	{
+		ResidencyStats stats{};
+		stats.budget = m_EffectiveBudget;
+		stats.residentBytes = m_ResidentBytes;
+		stats.textures = (uint32_t)m_Textures.size();
+		stats.evictions = m_EvictionCount;
+		stats.streamIns = m_StreamInCount;
+		return stats;
+	}
+
+	uint64_t ResidencyManager::resident_bytes(const ResidentTexture &texture, uint32_t baseLevel) const
+	{
+		uint64_t bytes = 0;
+		for (uint32_t level = baseLevel; level < texture.mipLevels; level++) {
+			bytes += ktx2_level_size(texture.format, texture.width, texture.height, level);
+		}
+
+		return bytes;
+	}
+
+	uint32_t ResidencyManager::max_base_level(const ResidentTexture &texture) const
+	{
+		uint32_t level = 0;
+		while (level + 1 < texture.mipLevels
+			&& std::max(texture.width >> (level + 1), texture.height >> (level + 1)) >= c_MinResidentSize) {
+			level++;
+		}
+
+		return level;
+	}
+
+	uint64_t ResidencyManager::effective_budget(uint64_t managedBytes) const
+	{
+		VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+		vmaGetHeapBudgets(m_Manager->get_allocator(), budgets);
+
+		const VkPhysicalDeviceMemoryProperties *properties;
+		vmaGetMemoryProperties(m_Manager->get_allocator(), &properties);
+
+		uint64_t heapBudget = 0;
+		uint64_t heapUsage = 0;
+		for (uint32_t i = 0; i < properties->memoryHeapCount; i++) {
+			if (!(properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) continue;
+
+			heapBudget += budgets[i].budget;
+			heapUsage += budgets[i].usage;
+		}
+
+		uint64_t budget = m_Budget ? m_Budget : (uint64_t)(heapBudget * c_DefaultBudgetFraction);
+
+		//everything else on the device comes first, the streamed textures give way when the heaps run full
+		if (heapUsage > heapBudget) {
+			uint64_t overshoot = heapUsage - heapBudget;
+			return std::min(budget, managedBytes > overshoot ? managedBytes - overshoot : 0);
+		}
+
+		return std::min(budget, managedBytes + (heapBudget - heapUsage));
+	}
+
+	void ResidencyManager::update()
+	{
+		ATL_EVENT();
+
+		VkDevice device = m_Manager->device();
+
+		for (auto it = m_PendingEvictions.begin(); it != m_PendingEvictions.end();) {
+			if (vkGetFenceStatus(device, it->fence) != VK_SUCCESS) {
+				it++;
+				continue;
+			}
+
+			vkFreeCommandBuffers(device, m_CommandPool, 1, &it->cmd);
+			vkDestroyFence(device, it->fence, nullptr);
+
+			it->texture->transitioning = false;
+
+			if (it->texture->texture.expired()) {
+				vmaDestroyImage(m_Manager->get_allocator(), it->image.image, it->image.allocation);
+			}
+			else {
+				swap_image(*it->texture, it->image, it->baseLevel);
+				m_EvictionCount++;
+			}
+
+			it = m_PendingEvictions.erase(it);
+		}
+
+		for (auto it = m_PendingStreamIns.begin(); it != m_PendingStreamIns.end();) {
+			TextureRequest::State state = it->request->state;
+
+			if (state == TextureRequest::State::Resident) {
+				AllocatedImage &image = it->request->texture.imageAllocation;
+
+				if (it->texture->texture.expired()) {
+					vmaDestroyImage(m_Manager->get_allocator(), image.image, image.allocation);
+				}
+				else {
+					swap_image(*it->texture, image, it->request->baseLevel);
+					m_StreamInCount++;
+				}
+			}
+			else if (state != TextureRequest::State::Failed) {
+				it++;
+				continue;
+			}
+
+			it->texture->transitioning = false;
+			it = m_PendingStreamIns.erase(it);
+		}
+
+		m_Textures.erase(std::remove_if(m_Textures.begin(), m_Textures.end(), [](const Ref<ResidentTexture> &texture) {
+			return texture->texture.expired() && !texture->transitioning;
+		}), m_Textures.end());
+
+		m_ResidentBytes = 0;
+		for (auto &texture : m_Textures) m_ResidentBytes += resident_bytes(*texture, texture->baseLevel);
+
+		m_EffectiveBudget = effective_budget(m_ResidentBytes);
+
+		std::vector<Ref<ResidentTexture>> candidates;
+		for (auto &texture : m_Textures) {
+			if (!texture->transitioning && !texture->texture.expired()) candidates.push_back(texture);
+		}
+
+		uint64_t bytes = m_ResidentBytes;
+		uint32_t started = 0;
+
+		if (bytes > m_EffectiveBudget) {
+			std::sort(candidates.begin(), candidates.end(), [](const Ref<ResidentTexture> &a, const Ref<ResidentTexture> &b) {
+				return a->lastUsedFrame < b->lastUsedFrame;
+			});
+
+			//textures on screen only drop the mips they don't need, the others lose one level per frame.
+			//if that isn't enough the textures on screen go below their screen size as well
+			for (uint32_t pass = 0; pass < 2; pass++) {
+				for (auto &texture : candidates) {
+					if (bytes <= m_EffectiveBudget || started >= c_MaxTransitionsPerFrame) break;
+					if (texture->transitioning) continue;
+
+					bool recent = m_Frame - texture->lastUsedFrame <= c_RecentFrames;
+					uint32_t target = recent && pass == 0 ? texture->desiredLevel : texture->baseLevel + 1;
+					target = std::min(target, max_base_level(*texture));
+
+					if (target <= texture->baseLevel) continue;
+
+					bytes -= resident_bytes(*texture, texture->baseLevel) - resident_bytes(*texture, target);
+					evict(texture, target);
+					started++;
+				}
+			}
+		}
+		else {
+			std::sort(candidates.begin(), candidates.end(), [](const Ref<ResidentTexture> &a, const Ref<ResidentTexture> &b) {
+				return a->lastUsedFrame > b->lastUsedFrame;
+			});
+
+			uint64_t limit = (uint64_t)(m_EffectiveBudget * c_StreamInThreshold);
+
+			for (auto &texture : candidates) {
+				if (started >= c_MaxTransitionsPerFrame) break;
+				if (m_Frame - texture->lastUsedFrame > c_RecentFrames) break;
+				if (texture->desiredLevel >= texture->baseLevel) continue;
+
+				uint64_t extra = resident_bytes(*texture, texture->desiredLevel) - resident_bytes(*texture, texture->baseLevel);
+				if (bytes + extra > limit) continue;
+
+				m_PendingStreamIns.push_back({ texture, m_Streamer->reload(*texture, texture->desiredLevel) });
+				texture->transitioning = true;
+
+				bytes += extra;
+				started++;
+			}
+		}
+
+		m_Frame++;
+	}
+
+	void ResidencyManager::evict(const Ref<ResidentTexture> &texture, uint32_t baseLevel)
+	{
+		Ref<VkTexture> shared = texture->texture.lock();
+		VkTexture &tex = *shared;
+		VkDevice device = m_Manager->device();
+
+		//the levels from baseLevel on are copied out of the current image, nothing has to be decoded
+		uint32_t dropped = baseLevel - texture->baseLevel;
+		uint32_t levels = texture->mipLevels - baseLevel;
+		uint32_t width = std::max(1u, texture->width >> baseLevel);
+		uint32_t height = std::max(1u, texture->height >> baseLevel);
+
+		PendingEviction eviction{};
+		eviction.texture = texture;
+		eviction.baseLevel = baseLevel;
+
+		create_image(*m_Manager, width, height, texture->format,
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, &eviction.image, levels);
+
+		VkCommandBufferAllocateInfo allocInfo = vkinit::command_buffer_allocate_info(m_CommandPool);
+		VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &eviction.cmd));
+
+		VkFenceCreateInfo fenceInfo = vkinit::fence_create_info();
+		VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &eviction.fence));
+
+		VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		VK_CHECK(vkBeginCommandBuffer(eviction.cmd, &beginInfo));
+
+		VkImageSubresourceRange dstRange{};
+		dstRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		dstRange.levelCount = levels;
+		dstRange.layerCount = 1;
+
+		VkImageSubresourceRange srcRange = dstRange;
+		srcRange.baseMipLevel = dropped;
+
+		insert_image_memory_barrier(eviction.cmd, eviction.image.image,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			dstRange);
+
+		insert_image_memory_barrier(eviction.cmd, tex.imageAllocation.image,
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			tex.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			srcRange);
+
+		std::vector<VkImageCopy> regions(levels);
+		for (uint32_t level = 0; level < levels; level++) {
+			VkImageCopy &region = regions[level];
+			region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.srcSubresource.mipLevel = dropped + level;
+			region.srcSubresource.layerCount = 1;
+			region.dstSubresource = region.srcSubresource;
+			region.dstSubresource.mipLevel = level;
+			region.extent = { std::max(1u, width >> level), std::max(1u, height >> level), 1 };
+		}
+
+		vkCmdCopyImage(eviction.cmd, tex.imageAllocation.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			eviction.image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+		//the current image stays bound until the copy finished
+		insert_image_memory_barrier(eviction.cmd, tex.imageAllocation.image,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, tex.layout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			srcRange);
+
+		insert_image_memory_barrier(eviction.cmd, eviction.image.image,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, tex.layout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			dstRange);
+
+		VK_CHECK(vkEndCommandBuffer(eviction.cmd));
+
+		VkSubmitInfo submit = vkinit::submit_info(&eviction.cmd);
+		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submit, eviction.fence));
+
+		texture->transitioning = true;
+		m_PendingEvictions.push_back(eviction);
+	}
+
+	void ResidencyManager::swap_image(ResidentTexture &texture, const AllocatedImage &image, uint32_t baseLevel)
+	{
+		Ref<VkTexture> shared = texture.texture.lock();
+		VkTexture &tex = *shared;
+		VkDevice device = m_Manager->device();
+
+		//called after the frame fence, nothing in flight reads the old image anymore
+		vkDestroyImageView(device, tex.imageView, nullptr);
+		vmaDestroyImage(m_Manager->get_allocator(), tex.imageAllocation.image, tex.imageAllocation.allocation);
+		//the descriptor of the old view is created again on the next get_id
+		if (tex.imguiDescriptor) ImGui_ImplVulkan_RemoveTexture(tex.imguiDescriptor);
+		tex.imguiDescriptor = VK_NULL_HANDLE;
+		m_Manager->get_sampler_cache().release(tex.sampler);
+
+		tex.imageAllocation = image;
+		tex.width = std::max(1u, texture.width >> baseLevel);
+		tex.height = std::max(1u, texture.height >> baseLevel);
+		tex.mipLevels = texture.mipLevels - baseLevel;
+
+		VkImageViewCreateInfo viewInfo = vkinit::imageview_create_info(tex.format, tex.imageAllocation.image,
+			VK_IMAGE_ASPECT_COLOR_BIT, tex.mipLevels);
+		VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &tex.imageView));
+
+		VkSamplerCreateInfo samplerInfo = texture.samplerInfo;
+		samplerInfo.maxLod = (float)tex.mipLevels;
+		tex.sampler = m_Manager->get_sampler_cache().acquire(samplerInfo);
+
+		texture.baseLevel = baseLevel;
+	}
+
+}
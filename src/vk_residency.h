@@ -0,0 +1,102 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+	class TextureStreamer;
+	struct TextureRequest;
+
+	struct ResidentTexture {
+		WeakRef<VkTexture> texture;
+
+		std::string path;
+		VkSamplerCreateInfo samplerInfo{};
+		bool mipmaps{ true };
+
+		//the full chain, level 0 is the size of the file
+		VkFormat format{ VK_FORMAT_UNDEFINED };
+		uint32_t width{ 0 }, height{ 0 };
+		uint32_t mipLevels{ 1 };
+
+		//first level of the full chain that is in memory
+		uint32_t baseLevel{ 0 };
+		//smallest level any use asked for during lastUsedFrame
+		uint32_t desiredLevel{ 0 };
+		uint64_t lastUsedFrame{ 0 };
+
+		bool transitioning{ false };
+	};
+
+	struct ResidencyStats {
+		uint64_t budget{ 0 };
+		uint64_t residentBytes{ 0 };
+		uint32_t textures{ 0 };
+		uint32_t evictions{ 0 };
+		uint32_t streamIns{ 0 };
+	};
+
+	// keeps the streamed textures inside a vram budget. textures that are over budget lose their largest mips in
+	// least recently used order, textures that are on screen get the mips their screen size needs streamed back in
+	class ResidencyManager {
+	public:
+
+		void init(VulkanManager &manager, TextureStreamer &streamer, VkQueue graphicsQueue, uint32_t graphicsFamily);
+		void cleanup();
+
+		//textures without a mip chain can't be streamed and are not tracked
+		Ref<ResidentTexture> track(const TextureRequest &request, WeakRef<VkTexture> texture);
+
+		//screenSize is the size of the largest side on screen in pixels, 0 asks for the full resolution
+		void mark_used(ResidentTexture &texture, float screenSize);
+
+		//0 derives the budget from the device local heaps, see c_DefaultBudgetFraction
+		void set_budget(uint64_t bytes);
+		ResidencyStats get_stats() const;
+
+		//starts evictions / stream ins for this frame and swaps in the ones that finished
+		void update();
+
+	private:
+
+		struct PendingEviction {
+			Ref<ResidentTexture> texture;
+			uint32_t baseLevel;
+			AllocatedImage image;
+			VkCommandBuffer cmd;
+			VkFence fence;
+		};
+
+		struct PendingStreamIn {
+			Ref<ResidentTexture> texture;
+			Ref<TextureRequest> request;
+		};
+
+		uint64_t resident_bytes(const ResidentTexture &texture, uint32_t baseLevel) const;
+		uint32_t max_base_level(const ResidentTexture &texture) const;
+		uint64_t effective_budget(uint64_t managedBytes) const;
+
+		void evict(const Ref<ResidentTexture> &texture, uint32_t baseLevel);
+		//replaces the image of the texture, the old one is no longer in use
+		void swap_image(ResidentTexture &texture, const AllocatedImage &image, uint32_t baseLevel);
+
+		VulkanManager *m_Manager{ nullptr };
+		TextureStreamer *m_Streamer{ nullptr };
+
+		VkQueue m_GraphicsQueue{ VK_NULL_HANDLE };
+		VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+
+		uint64_t m_Budget{ 0 };
+		uint64_t m_EffectiveBudget{ 0 };
+		uint64_t m_Frame{ 1 };
+		uint64_t m_ResidentBytes{ 0 };
+		uint32_t m_EvictionCount{ 0 };
+		uint32_t m_StreamInCount{ 0 };
+
+		std::vector<Ref<ResidentTexture>> m_Textures;
+		std::vector<PendingEviction> m_PendingEvictions;
+		std::vector<PendingStreamIn> m_PendingStreamIns;
+	};
+
+}
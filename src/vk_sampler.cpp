@@ -0,0 +1,122 @@
+#include "vk_sampler.h"
+
+namespace vkutil {
+
+	//floats are compared and hashed by their bit pattern, so equal keys always hash equally
+	static uint32_t float_bits(float value) {
+		uint32_t result;
+		std::memcpy(&result, &value, sizeof(float));
+		return result;
+	}
+
+	void SamplerCache::init(VkDevice device) {
+		m_Device = device;
+	}
+
+	void SamplerCache::cleanup() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (!m_Samplers.empty()) CORE_WARN("SamplerCache: {} samplers were never released", m_Samplers.size());
+
+		for (auto &[info, entry] : m_Samplers) vkDestroySampler(m_Device, entry.sampler, nullptr);
+
+		m_Samplers.clear();
+		m_Infos.clear();
+	}
+
+	VkSampler SamplerCache::acquire(const VkSamplerCreateInfo &info) {
+		CORE_ASSERT(m_Device, "SamplerCache is not initialized");
+		CORE_ASSERT(info.pNext == nullptr, "SamplerCache does not support pNext chains");
+
+		SamplerInfo samplerInfo(info);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto it = m_Samplers.find(samplerInfo);
+		if (it != m_Samplers.end()) {
+			m_Hits++;
+			it->second.refCount++;
+			return it->second.sampler;
+		}
+
+		m_Misses++;
+
+		VkSampler sampler{ VK_NULL_HANDLE };
+		VK_CHECK(vkCreateSampler(m_Device, &info, nullptr, &sampler));
+		if (sampler == VK_NULL_HANDLE) return VK_NULL_HANDLE;
+
+		m_Samplers.emplace(samplerInfo, SamplerEntry{ sampler, 1 });
+		m_Infos.emplace(sampler, samplerInfo);
+
+		return sampler;
+	}
+
+	void SamplerCache::release(VkSampler sampler) {
+		if (sampler == VK_NULL_HANDLE) return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto infoIt = m_Infos.find(sampler);
+		if (infoIt == m_Infos.end()) {
+			CORE_WARN("SamplerCache: released a sampler that was not acquired from the cache");
+			return;
+		}
+
+		auto it = m_Samplers.find(infoIt->second);
+		if (--it->second.refCount > 0) return;
+
+		vkDestroySampler(m_Device, sampler, nullptr);
+		m_Samplers.erase(it);
+		m_Infos.erase(infoIt);
+	}
+
+	CacheStats SamplerCache::get_stats() {
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		CacheStats stats{};
+		stats.hits = m_Hits;
+		stats.misses = m_Misses;
+		stats.size = m_Samplers.size();
+		return stats;
+	}
+
+	SamplerCache::SamplerInfo::SamplerInfo(const VkSamplerCreateInfo &info)
+		: flags(info.flags), magFilter(info.magFilter), minFilter(info.minFilter), mipmapMode(info.mipmapMode),
+		addressModeU(info.addressModeU), addressModeV(info.addressModeV), addressModeW(info.addressModeW),
+		mipLodBias(info.mipLodBias), anisotropyEnable(info.anisotropyEnable), maxAnisotropy(info.maxAnisotropy),
+		compareEnable(info.compareEnable), compareOp(info.compareOp), minLod(info.minLod), maxLod(info.maxLod),
+		borderColor(info.borderColor), unnormalizedCoordinates(info.unnormalizedCoordinates) {}
+
+	bool SamplerCache::SamplerInfo::operator==(const SamplerInfo &other) const {
+		return flags == other.flags && magFilter == other.magFilter && minFilter == other.minFilter
+			&& mipmapMode == other.mipmapMode && addressModeU == other.addressModeU
+			&& addressModeV == other.addressModeV && addressModeW == other.addressModeW
+			&& float_bits(mipLodBias) == float_bits(other.mipLodBias) && anisotropyEnable == other.anisotropyEnable
+			&& float_bits(maxAnisotropy) == float_bits(other.maxAnisotropy) && compareEnable == other.compareEnable
+			&& compareOp == other.compareOp && float_bits(minLod) == float_bits(other.minLod)
+			&& float_bits(maxLod) == float_bits(other.maxLod)
+			&& borderColor == other.borderColor && unnormalizedCoordinates == other.unnormalizedCoordinates;
+	}
+
+	size_t SamplerCache::SamplerInfo::hash() const {
+		uint64_t result = hash_mix(flags);
+		result = hash_combine(result, magFilter);
+		result = hash_combine(result, minFilter);
+		result = hash_combine(result, mipmapMode);
+		result = hash_combine(result, addressModeU);
+		result = hash_combine(result, addressModeV);
+		result = hash_combine(result, addressModeW);
+		result = hash_combine(result, float_bits(mipLodBias));
+		result = hash_combine(result, anisotropyEnable);
+		result = hash_combine(result, float_bits(maxAnisotropy));
+		result = hash_combine(result, compareEnable);
+		result = hash_combine(result, compareOp);
+		result = hash_combine(result, float_bits(minLod));
+		result = hash_combine(result, float_bits(maxLod));
+		result = hash_combine(result, borderColor);
+		result = hash_combine(result, unnormalizedCoordinates);
+
+		return (size_t)result;
+	}
+
+}
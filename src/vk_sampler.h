@@ -0,0 +1,73 @@
+#pragma once
+
+#include "vk_types.h"
+#include "vk_cache.h"
+
+namespace vkutil {
+
+	//samplers only depend on their create info, so textures with the same settings share one.
+	//devices limit the number of samplers (maxSamplerAllocationCount), one per texture runs into it quickly
+	class SamplerCache {
+	public:
+
+		SamplerCache() = default;
+
+		void init(VkDevice device);
+		void cleanup();
+
+		//every acquire has to be matched by a release, the sampler is destroyed with the last one
+		//pNext chains are not part of the key and are not supported
+		VkSampler acquire(const VkSamplerCreateInfo &info);
+		void release(VkSampler sampler);
+
+		CacheStats get_stats();
+
+		struct SamplerInfo {
+			VkSamplerCreateFlags flags;
+			VkFilter magFilter;
+			VkFilter minFilter;
+			VkSamplerMipmapMode mipmapMode;
+			VkSamplerAddressMode addressModeU;
+			VkSamplerAddressMode addressModeV;
+			VkSamplerAddressMode addressModeW;
+			float mipLodBias;
+			VkBool32 anisotropyEnable;
+			float maxAnisotropy;
+			VkBool32 compareEnable;
+			VkCompareOp compareOp;
+			float minLod;
+			float maxLod;
+			VkBorderColor borderColor;
+			VkBool32 unnormalizedCoordinates;
+
+			SamplerInfo(const VkSamplerCreateInfo &info);
+
+			bool operator==(const SamplerInfo &other) const;
+
+			size_t hash() const;
+		};
+
+	private:
+
+		struct SamplerHash {
+			std::size_t operator()(const SamplerInfo &k) const {
+				return k.hash();
+			}
+		};
+
+		struct SamplerEntry {
+			VkSampler sampler{ VK_NULL_HANDLE };
+			uint32_t refCount{ 0 };
+		};
+
+		VkDevice m_Device{ VK_NULL_HANDLE };
+
+		std::mutex m_Mutex;
+		std::unordered_map<SamplerInfo, SamplerEntry, SamplerHash> m_Samplers;
+		std::unordered_map<VkSampler, SamplerInfo> m_Infos;
+
+		uint64_t m_Hits{ 0 };
+		uint64_t m_Misses{ 0 };
+	};
+
+}
@@ -0,0 +1,230 @@
+#include "vk_statistics.h"
+
+#include "vk_manager.h"
+
+namespace vkutil {
+
+	static const uint32_t c_StatisticsFrames = 3;
+	//one query per graphics command buffer of a frame, sync_async_compute splits it once
+	static const uint32_t c_MaxQueries = 4;
+	static const size_t c_HistorySize = 100;
+
+	//the results are written in the order of the bits
+	static const VkQueryPipelineStatisticFlags c_PipelineStatistics =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+		| VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+	static const uint32_t c_PipelineStatisticCount = 5;
+
+	static std::array<std::atomic<uint32_t>, (size_t)FrameCounter::COUNT> s_Counters{};
+
+	void count(FrameCounter counter, uint32_t n)
+	{
+		s_Counters[(size_t)counter].fetch_add(n, std::memory_order_relaxed);
+	}
+
+	const char *counter_name(FrameCounter counter)
+	{
+		switch (counter) {
+		case FrameCounter::DRAWS: return "draws";
+		case FrameCounter::DISPATCHES: return "dispatches";
+		case FrameCounter::RENDER_PASSES: return "render_passes";
+		case FrameCounter::SHADER_BINDS: return "shader_binds";
+		case FrameCounter::BUFFER_BINDS: return "buffer_binds";
+		case FrameCounter::DESCRIPTOR_BINDS: return "descriptor_binds";
+		case FrameCounter::DESCRIPTOR_PUSHES: return "descriptor_pushes";
+		case FrameCounter::BARRIERS: return "barriers";
+		default: CORE_ASSERT(false, "never called");
+		}
+
+		return "";
+	}
+
+	void FrameStatistics::init(VulkanManager &manager, bool pipelineStatistics)
+	{
+		m_Manager = &manager;
+		m_PipelineStatistics = pipelineStatistics;
+
+		if (!m_PipelineStatistics) return;
+
+		VkQueryPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		poolInfo.queryCount = c_MaxQueries;
+		poolInfo.pipelineStatistics = c_PipelineStatistics;
+
+		m_Frames.resize(c_StatisticsFrames);
+		for (auto &frame : m_Frames) VK_CHECK(vkCreateQueryPool(manager.device(), &poolInfo, nullptr, &frame.pool));
+	}
+
+	void FrameStatistics::cleanup()
+	{
+		for (auto &frame : m_Frames) vkDestroyQueryPool(m_Manager->device(), frame.pool, nullptr);
+		m_Frames.clear();
+	}
+
+	void FrameStatistics::begin_frame(VkCommandBuffer cmd)
+	{
+		FrameStatisticsData data{};
+		data.frame = m_Frame;
+		for (size_t i = 0; i < s_Counters.size(); i++) data.counters[i] = s_Counters[i].exchange(0, std::memory_order_relaxed);
+
+		//the counts before the first frame are from loading
+		if (m_Frame > 0) {
+			m_Last = data;
+			m_History.push_back(data);
+			if (m_History.size() > c_HistorySize) m_History.pop_front();
+		}
+
+		m_Frame++;
+
+		if (!m_PipelineStatistics) return;
+
+		m_FrameIndex = (m_FrameIndex + 1) % c_StatisticsFrames;
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+
+		resolve(frame);
+
+		frame.frame = m_Frame;
+		frame.queryCount = 1;
+		frame.recorded = false;
+		m_Recording = true;
+		m_Suspended = false;
+
+		vkCmdResetQueryPool(cmd, frame.pool, 0, c_MaxQueries);
+		vkCmdBeginQuery(cmd, frame.pool, 0, 0);
+	}
+
+	void FrameStatistics::suspend(VkCommandBuffer cmd)
+	{
+		if (!m_Recording || m_Suspended) return;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		vkCmdEndQuery(cmd, frame.pool, frame.queryCount - 1);
+		m_Suspended = true;
+	}
+
+	void FrameStatistics::resume(VkCommandBuffer cmd)
+	{
+		if (!m_Recording || !m_Suspended) return;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		if (frame.queryCount == c_MaxQueries) {
+			CORE_WARN("FrameStatistics: the frame was split into more than {} command buffers", c_MaxQueries);
+			return;
+		}
+
+		vkCmdBeginQuery(cmd, frame.pool, frame.queryCount, 0);
+		frame.queryCount++;
+		m_Suspended = false;
+	}
+
+	void FrameStatistics::end_frame(VkCommandBuffer cmd)
+	{
+		if (!m_Recording) return;
+
+		QueryFrame &frame = m_Frames[m_FrameIndex];
+		if (!m_Suspended) vkCmdEndQuery(cmd, frame.pool, frame.queryCount - 1);
+
+		frame.recorded = true;
+		m_Recording = false;
+	}
+
+	bool FrameStatistics::has_pipeline_statistics() const
+	{
+		return m_PipelineStatistics;
+	}
+
+	const FrameStatisticsData &FrameStatistics::get_last() const
+	{
+		return m_Last;
+	}
+
+	const FrameStatisticsData *FrameStatistics::get_last_pipeline() const
+	{
+		for (auto it = m_History.rbegin(); it != m_History.rend(); it++) {
+			if (it->hasPipeline) return &*it;
+		}
+
+		return nullptr;
+	}
+
+	const std::deque<FrameStatisticsData> &FrameStatistics::get_history() const
+	{
+		return m_History;
+	}
+
+	void FrameStatistics::resolve(QueryFrame &frame)
+	{
+		if (!frame.recorded) return;
+		frame.recorded = false;
+
+		//the statistics followed by the availability of every query
+		const uint32_t stride = c_PipelineStatisticCount + 1;
+		std::vector<uint64_t> results(frame.queryCount * stride);
+		VkResult result = vkGetQueryPoolResults(m_Manager->device(), frame.pool, 0, frame.queryCount,
+			results.size() * sizeof(uint64_t), results.data(), stride * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		if (result != VK_SUCCESS && result != VK_NOT_READY) {
+			CORE_WARN("FrameStatistics: could not read the pipeline statistics, {}", result);
+			return;
+		}
+
+		uint64_t sums[c_PipelineStatisticCount]{};
+		for (uint32_t query = 0; query < frame.queryCount; query++) {
+			const uint64_t *values = &results[query * stride];
+			if (!values[c_PipelineStatisticCount]) return;
+
+			for (uint32_t i = 0; i < c_PipelineStatisticCount; i++) sums[i] += values[i];
+		}
+
+		auto it = std::find_if(m_History.begin(), m_History.end(), [&](const FrameStatisticsData &d) { return d.frame == frame.frame; });
+		if (it == m_History.end()) return;
+
+		it->pipeline = { sums[0], sums[1], sums[2], sums[3], sums[4] };
+		it->hasPipeline = true;
+	}
+
+	std::string FrameStatistics::to_json() const
+	{
+		std::ostringstream json;
+		json << "{\n\t\"pipelineStatistics\": " << (m_PipelineStatistics ? "true" : "false") << ",\n\t\"frames\": [";
+
+		for (size_t i = 0; i < m_History.size(); i++) {
+			const FrameStatisticsData &data = m_History[i];
+
+			json << (i > 0 ? "," : "") << "\n\t\t{ \"frame\": " << data.frame;
+			for (uint32_t c = 0; c < (uint32_t)FrameCounter::COUNT; c++) {
+				json << ", \"" << counter_name((FrameCounter)c) << "\": " << data.counters[c];
+			}
+
+			if (data.hasPipeline) {
+				const PipelineStatistics &p = data.pipeline;
+				json << ", \"input_vertices\": " << p.inputVertices << ", \"vertex_invocations\": " << p.vertexInvocations
+					<< ", \"clipping_primitives\": " << p.clippingPrimitives << ", \"fragment_invocations\": " << p.fragmentInvocations
+					<< ", \"compute_invocations\": " << p.computeInvocations;
+			}
+
+			json << " }";
+		}
+
+		json << "\n\t]\n}\n";
+		return json.str();
+	}
+
+	bool FrameStatistics::save_json(const std::filesystem::path &path) const
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file) {
+			CORE_WARN("FrameStatistics: could not open {}", path.string());
+			return false;
+		}
+
+		file << to_json();
+		return (bool)file;
+	}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+
+	enum class FrameCounter : uint32_t {
+		DRAWS,
+		DISPATCHES,
+		RENDER_PASSES,
+		SHADER_BINDS,
+		BUFFER_BINDS,
+		DESCRIPTOR_BINDS,
+		DESCRIPTOR_PUSHES,
+		BARRIERS,
+		COUNT,
+	};
+
+	//adds to a counter of the current frame, cheap enough to be called for every draw. thread safe, barriers
+	//recorded by uploads on other threads are counted for the frame they are recorded in
+	void count(FrameCounter counter, uint32_t n = 1);
+	const char *counter_name(FrameCounter counter);
+
+	struct PipelineStatistics {
+		uint64_t inputVertices;
+		uint64_t vertexInvocations;
+		uint64_t clippingPrimitives;
+		uint64_t fragmentInvocations;
+		uint64_t computeInvocations;
+	};
+
+	struct FrameStatisticsData {
+		uint64_t frame;
+		std::array<uint32_t, (size_t)FrameCounter::COUNT> counters;
+		//async compute work is not part of it
+		PipelineStatistics pipeline;
+		bool hasPipeline;
+
+		uint32_t operator[](FrameCounter counter) const { return counters[(size_t)counter]; }
+	};
+
+	// call counters of the frames and, if the device supports it, a pipeline statistics query over their graphics
+	// work. the queries use a ring of pools and are read without waiting, a few frames after the counters
+	class FrameStatistics {
+	public:
+
+		void init(VulkanManager &manager, bool pipelineStatistics);
+		void cleanup();
+
+		//closes the counters of the last frame and starts the query of the new one, outside of a render pass
+		void begin_frame(VkCommandBuffer cmd);
+		//queries can not span command buffers. suspend before cmd is ended, resume in the one the frame continues in
+		void suspend(VkCommandBuffer cmd);
+		void resume(VkCommandBuffer cmd);
+		void end_frame(VkCommandBuffer cmd);
+
+		bool has_pipeline_statistics() const;
+		//the newest frame with finished counters, its pipeline statistics are resolved a few frames later
+		const FrameStatisticsData &get_last() const;
+		//the newest frame with pipeline statistics
+		const FrameStatisticsData *get_last_pipeline() const;
+		const std::deque<FrameStatisticsData> &get_history() const;
+
+		std::string to_json() const;
+		bool save_json(const std::filesystem::path &path) const;
+
+	private:
+
+		struct QueryFrame {
+			VkQueryPool pool{ VK_NULL_HANDLE };
+			uint64_t frame{ 0 };
+			uint32_t queryCount{ 0 };
+			bool recorded{ false };
+		};
+
+		void resolve(QueryFrame &frame);
+
+		VulkanManager *m_Manager{ nullptr };
+		bool m_PipelineStatistics{ false };
+
+		std::vector<QueryFrame> m_Frames;
+		uint32_t m_FrameIndex{ 0 };
+		bool m_Recording{ false };
+		bool m_Suspended{ false };
+
+		uint64_t m_Frame{ 0 };
+		FrameStatisticsData m_Last{};
+		std::deque<FrameStatisticsData> m_History;
+	};
+
+}
@@ -0,0 +1,453 @@
+#include "vk_texture_streamer.h"
+
+#include "vk_manager.h"
+#include "vk_initializers.h"
+#include "vk_residency.h"
+#include "ktx2.h"
+
+#include "application.h"
+
+#include <stb_image.h>
+
+namespace vkutil {
+
+	//staging bytes submitted per frame, a single larger texture is still let through
+	static const VkDeviceSize c_UploadBudgetPerFrame = 32 * 1024 * 1024;
+
+	//2x2 box filter, used to start png reloads below level 0
+	static std::vector<uint8_t> downsample_rgba8(const uint8_t *texels, uint32_t width, uint32_t height,
+		uint32_t *outWidth, uint32_t *outHeight)
+	{
+		uint32_t w = std::max(1u, width / 2);
+		uint32_t h = std::max(1u, height / 2);
+
+		std::vector<uint8_t> result((size_t)w * h * 4);
+
+		for (uint32_t y = 0; y < h; y++) {
+			for (uint32_t x = 0; x < w; x++) {
+				uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+				uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+
+				for (uint32_t c = 0; c < 4; c++) {
+					uint32_t sum = texels[((size_t)y0 * width + x0) * 4 + c] + texels[((size_t)y0 * width + x1) * 4 + c]
+						+ texels[((size_t)y1 * width + x0) * 4 + c] + texels[((size_t)y1 * width + x1) * 4 + c];
+					result[((size_t)y * w + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+				}
+			}
+		}
+
+		*outWidth = w;
+		*outHeight = h;
+		return result;
+	}
+
+	static void image_barrier(VkCommandBuffer cmd, VkImage image, uint32_t levelCount,
+		VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess, VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess,
+		uint32_t srcFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstFamily = VK_QUEUE_FAMILY_IGNORED)
+	{
+		VkImageMemoryBarrier2 barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+		barrier.srcStageMask = srcStage;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStage;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.layerCount = 1;
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.imageMemoryBarrierCount = 1;
+		dependencyInfo.pImageMemoryBarriers = &barrier;
+
+		vkCmdPipelineBarrier2(cmd, &dependencyInfo);
+	}
+
+	void TextureStreamer::init(VulkanManager &manager, AssetManager &assets, ResidencyManager &residency, VkQueue graphicsQueue,
+		uint32_t graphicsFamily, VkQueue transferQueue, uint32_t transferFamily)
+	{
+		m_Manager = &manager;
+		m_Assets = &assets;
+		m_Residency = &residency;
+		m_GraphicsQueue = graphicsQueue;
+		m_GraphicsFamily = graphicsFamily;
+		m_TransferQueue = transferQueue;
+		m_TransferFamily = transferFamily;
+
+		VkCommandPoolCreateInfo graphicsPoolInfo = vkinit::command_pool_create_info(graphicsFamily,
+			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		VK_CHECK(vkCreateCommandPool(manager.device(), &graphicsPoolInfo, nullptr, &m_GraphicsPool));
+
+		if (m_TransferFamily != m_GraphicsFamily) {
+			VkCommandPoolCreateInfo transferPoolInfo = vkinit::command_pool_create_info(transferFamily,
+				VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+			VK_CHECK(vkCreateCommandPool(manager.device(), &transferPoolInfo, nullptr, &m_TransferPool));
+		}
+
+		TextureCreateInfo info = color_texture_create_info(1, 1, VK_FORMAT_R8G8B8A8_UNORM);
+		info.filter = VK_FILTER_NEAREST;
+		alloc_texture(manager, info, &m_Placeholder);
+
+		uint32_t white = 0xffffffff;
+		set_texture_data(manager, m_Placeholder, &white);
+	}
+
+	void TextureStreamer::cleanup()
+	{
+		//the device is idle, unfinished uploads are dropped
+		for (auto &request : m_Requests) {
+			if (request->state == TextureRequest::State::Uploading) {
+				request->cancelled = true;
+				finish(*request);
+			}
+			else release_staging(*request);
+		}
+
+		m_Requests.clear();
+
+		destroy_texture(*m_Manager, m_Placeholder);
+
+		vkDestroyCommandPool(m_Manager->device(), m_GraphicsPool, nullptr);
+		if (m_TransferPool) vkDestroyCommandPool(m_Manager->device(), m_TransferPool, nullptr);
+	}
+
+	Ref<TextureRequest> TextureStreamer::request(const char *path, const VkSamplerCreateInfo &samplerInfo, bool mipmaps)
+	{
+		Ref<TextureRequest> request = make_ref<TextureRequest>();
+		request->path = path;
+		request->samplerInfo = samplerInfo;
+		request->mipmaps = mipmaps;
+
+		schedule(request);
+		return request;
+	}
+
+	Ref<TextureRequest> TextureStreamer::reload(const ResidentTexture &texture, uint32_t baseLevel)
+	{
+		Ref<TextureRequest> request = make_ref<TextureRequest>();
+		request->path = texture.path;
+		request->samplerInfo = texture.samplerInfo;
+		request->mipmaps = texture.mipmaps;
+		request->baseLevel = baseLevel;
+		request->reload = true;
+
+		schedule(request);
+		return request;
+	}
+
+	void TextureStreamer::schedule(Ref<TextureRequest> request)
+	{
+		m_Requests.push_back(request);
+
+		VulkanManager *manager = m_Manager;
+		Atlas::Application::get_thread_pool().submit([request, manager]() {
+			decode(*manager, *request);
+		});
+	}
+
+	void TextureStreamer::decode(VulkanManager &manager, TextureRequest &request)
+	{
+		ATL_EVENT();
+
+		const char *file = request.path.c_str();
+
+		if (std::filesystem::path(request.path).extension() == ".ktx2") {
+			Ktx2Image image;
+			std::string error;
+			if (!read_ktx2(file, &image, &error)) {
+				CORE_WARN("Failed to load texture file: {}, message: {}", file, error);
+				request.state = TextureRequest::State::Failed;
+				return;
+			}
+
+			if (!supports_sampled_format(manager, image.format, request.samplerInfo.minFilter)) {
+				CORE_WARN("Failed to load texture file: {}, format {} can not be sampled on this device", file, image.format);
+				request.state = TextureRequest::State::Failed;
+				return;
+			}
+
+			uint32_t base = std::min(request.baseLevel, (uint32_t)image.levels.size() - 1);
+
+			request.format = image.format;
+			request.width = std::max(1u, image.width >> base);
+			request.height = std::max(1u, image.height >> base);
+			request.mipLevels = (uint32_t)image.levels.size() - base;
+
+			//levels are stored largest first, the ones from base on are the tail of the data
+			VkDeviceSize baseOffset = image.levels[base].offset;
+
+			for (uint32_t level = base; level < (uint32_t)image.levels.size(); level++) {
+				VkBufferImageCopy region{};
+				region.bufferOffset = image.levels[level].offset - baseOffset;
+				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				region.imageSubresource.mipLevel = level - base;
+				region.imageSubresource.layerCount = 1;
+				region.imageExtent = { std::max(1u, image.width >> level), std::max(1u, image.height >> level), 1 };
+
+				request.regions.push_back(region);
+			}
+
+			request.stagingSize = image.data.size() - baseOffset;
+			create_buffer(manager, request.stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&request.staging);
+			map_memory(manager, request.staging, image.data.data() + baseOffset, (uint32_t)request.stagingSize);
+		}
+		else {
+			int w, h, nC;
+			stbi_uc *pixels = stbi_load(file, &w, &h, &nC, STBI_rgb_alpha);
+			if (!pixels) {
+				CORE_WARN("Failed to load texture file: {}, message: {}", file, stbi_failure_reason());
+				request.state = TextureRequest::State::Failed;
+				return;
+			}
+
+			request.format = VK_FORMAT_R8G8B8A8_UNORM;
+			request.width = (uint32_t)w;
+			request.height = (uint32_t)h;
+
+			std::vector<uint8_t> reduced;
+			const uint8_t *texels = pixels;
+			for (uint32_t level = 0; level < request.baseLevel && (request.width > 1 || request.height > 1); level++) {
+				reduced = downsample_rgba8(texels, request.width, request.height, &request.width, &request.height);
+				texels = reduced.data();
+			}
+
+			if (request.mipmaps && supports_mip_generation(manager, request.format)) {
+				request.mipLevels = mip_level_count(request.width, request.height);
+				request.generateMips = request.mipLevels > 1;
+			}
+
+			VkBufferImageCopy region{};
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { request.width, request.height, 1 };
+			request.regions.push_back(region);
+
+			request.stagingSize = (VkDeviceSize)request.width * request.height * 4;
+			create_buffer(manager, request.stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&request.staging);
+			map_memory(manager, request.staging, (void *)texels, (uint32_t)request.stagingSize);
+
+			stbi_image_free(pixels);
+		}
+
+		request.state = TextureRequest::State::Decoded;
+	}
+
+	void TextureStreamer::update()
+	{
+		ATL_EVENT();
+
+		VkDeviceSize submitted = 0;
+
+		for (auto it = m_Requests.begin(); it != m_Requests.end();) {
+			TextureRequest &request = **it;
+
+			switch (request.state.load()) {
+			case TextureRequest::State::Decoded:
+				if (request.cancelled) {
+					release_staging(request);
+					it = m_Requests.erase(it);
+					continue;
+				}
+
+				if (submitted == 0 || submitted + request.stagingSize <= c_UploadBudgetPerFrame) {
+					submitted += request.stagingSize;
+					submit(request);
+				}
+				break;
+
+			case TextureRequest::State::Uploading:
+				if (vkGetFenceStatus(m_Manager->device(), request.uploadFence) == VK_SUCCESS) {
+					finish(request);
+					it = m_Requests.erase(it);
+					continue;
+				}
+				break;
+
+			case TextureRequest::State::Failed:
+				it = m_Requests.erase(it);
+				continue;
+
+			default:
+				break;
+			}
+
+			it++;
+		}
+	}
+
+	void TextureStreamer::submit(TextureRequest &request)
+	{
+		VkDevice device = m_Manager->device();
+		VkTexture &tex = request.texture;
+
+		tex.format = request.format;
+		tex.width = request.width;
+		tex.height = request.height;
+		tex.mipLevels = request.mipLevels;
+		tex.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		//transfer src for mip generation and for the residency manager dropping levels
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+		create_image(*m_Manager, tex.width, tex.height, tex.format, usage, &tex.imageAllocation, tex.mipLevels);
+
+		VkImage image = tex.imageAllocation.image;
+
+		//levels that are copied from the staging buffer, the others are blitted on the graphics queue
+		uint32_t copiedLevels = request.generateMips ? 1 : tex.mipLevels;
+		VkImageLayout copiedLayout = request.generateMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : tex.layout;
+
+		auto record_copy = [&](VkCommandBuffer cmd) {
+			image_barrier(cmd, image, copiedLevels,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_PIPELINE_STAGE_2_NONE, 0, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+
+			vkCmdCopyBufferToImage(cmd, request.staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				(uint32_t)request.regions.size(), request.regions.data());
+		};
+
+		auto record_finish = [&](VkCommandBuffer cmd) {
+			if (request.generateMips) {
+				generate_mipmaps(cmd, image, tex.width, tex.height, tex.mipLevels, tex.layout);
+			}
+		};
+
+		VkFenceCreateInfo fenceInfo = vkinit::fence_create_info();
+		VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &request.uploadFence));
+
+		VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		VkCommandBufferAllocateInfo graphicsAllocInfo = vkinit::command_buffer_allocate_info(m_GraphicsPool);
+		VK_CHECK(vkAllocateCommandBuffers(device, &graphicsAllocInfo, &request.graphicsCommandBuffer));
+		VkCommandBuffer graphicsCmd = request.graphicsCommandBuffer;
+
+		if (!m_TransferPool) {
+			VK_CHECK(vkBeginCommandBuffer(graphicsCmd, &beginInfo));
+			record_copy(graphicsCmd);
+
+			if (!request.generateMips) {
+				image_barrier(graphicsCmd, image, copiedLevels,
+					VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, tex.layout,
+					VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+					VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+			}
+
+			record_finish(graphicsCmd);
+			VK_CHECK(vkEndCommandBuffer(graphicsCmd));
+
+			VkSubmitInfo submit = vkinit::submit_info(&graphicsCmd);
+			VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submit, request.uploadFence));
+
+			request.state = TextureRequest::State::Uploading;
+			return;
+		}
+
+		//copy on the transfer queue, then hand the image over to the graphics queue
+		VkCommandBufferAllocateInfo transferAllocInfo = vkinit::command_buffer_allocate_info(m_TransferPool);
+		VK_CHECK(vkAllocateCommandBuffers(device, &transferAllocInfo, &request.transferCommandBuffer));
+		VkCommandBuffer transferCmd = request.transferCommandBuffer;
+
+		VkSemaphoreCreateInfo semaphoreInfo = vkinit::semaphore_create_info();
+		VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &request.transferSemaphore));
+
+		VK_CHECK(vkBeginCommandBuffer(transferCmd, &beginInfo));
+		record_copy(transferCmd);
+
+		image_barrier(transferCmd, image, copiedLevels,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copiedLayout,
+			VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, 0,
+			m_TransferFamily, m_GraphicsFamily);
+
+		VK_CHECK(vkEndCommandBuffer(transferCmd));
+
+		VK_CHECK(vkBeginCommandBuffer(graphicsCmd, &beginInfo));
+
+		VkPipelineStageFlags2 consumerStages = request.generateMips ? VK_PIPELINE_STAGE_2_TRANSFER_BIT
+			: VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		VkAccessFlags2 consumerAccess = request.generateMips ? VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT
+			: VK_ACCESS_2_SHADER_READ_BIT;
+
+		image_barrier(graphicsCmd, image, copiedLevels,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copiedLayout,
+			VK_PIPELINE_STAGE_2_NONE, 0, consumerStages, consumerAccess,
+			m_TransferFamily, m_GraphicsFamily);
+
+		record_finish(graphicsCmd);
+		VK_CHECK(vkEndCommandBuffer(graphicsCmd));
+
+		VkSubmitInfo transferSubmit = vkinit::submit_info(&transferCmd);
+		transferSubmit.signalSemaphoreCount = 1;
+		transferSubmit.pSignalSemaphores = &request.transferSemaphore;
+		VK_CHECK(vkQueueSubmit(m_TransferQueue, 1, &transferSubmit, VK_NULL_HANDLE));
+
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		VkSubmitInfo graphicsSubmit = vkinit::submit_info(&graphicsCmd);
+		graphicsSubmit.waitSemaphoreCount = 1;
+		graphicsSubmit.pWaitSemaphores = &request.transferSemaphore;
+		graphicsSubmit.pWaitDstStageMask = &waitStage;
+		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &graphicsSubmit, request.uploadFence));
+
+		request.state = TextureRequest::State::Uploading;
+	}
+
+	void TextureStreamer::finish(TextureRequest &request)
+	{
+		VkDevice device = m_Manager->device();
+
+		release_staging(request);
+
+		vkFreeCommandBuffers(device, m_GraphicsPool, 1, &request.graphicsCommandBuffer);
+		if (request.transferCommandBuffer) vkFreeCommandBuffers(device, m_TransferPool, 1, &request.transferCommandBuffer);
+		if (request.transferSemaphore) vkDestroySemaphore(device, request.transferSemaphore, nullptr);
+		vkDestroyFence(device, request.uploadFence, nullptr);
+
+		VkTexture &tex = request.texture;
+
+		if (request.cancelled) {
+			vmaDestroyImage(m_Manager->get_allocator(), tex.imageAllocation.image, tex.imageAllocation.allocation);
+			request.state = TextureRequest::State::Failed;
+			return;
+		}
+
+		if (request.reload) {
+			request.state = TextureRequest::State::Resident;
+			return;
+		}
+
+		VkImageViewCreateInfo viewInfo = vkinit::imageview_create_info(tex.format, tex.imageAllocation.image,
+			VK_IMAGE_ASPECT_COLOR_BIT, tex.mipLevels);
+		VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &tex.imageView));
+
+		request.samplerInfo.maxLod = (float)tex.mipLevels;
+		tex.sampler = m_Manager->get_sampler_cache().acquire(request.samplerInfo);
+
+		tex.bImguiDescriptor = true;
+
+		request.resident = m_Assets->register_texture(tex);
+		request.residency = m_Residency->track(request, request.resident);
+		request.state = TextureRequest::State::Resident;
+	}
+
+	void TextureStreamer::release_staging(TextureRequest &request)
+	{
+		if (!request.staging.buffer) return;
+
+		destroy_buffer(*m_Manager, request.staging);
+		request.staging = {};
+	}
+
+	VkTexture &TextureStreamer::get_placeholder()
+	{
+		return m_Placeholder;
+	}
+
+}
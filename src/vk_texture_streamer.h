@@ -0,0 +1,101 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+	class AssetManager;
+	class ResidencyManager;
+	struct ResidentTexture;
+
+	struct TextureRequest {
+		enum class State {
+			Decoding,
+			Decoded,
+			Uploading,
+			Resident,
+			Failed,
+		};
+
+		std::atomic<State> state{ State::Decoding };
+		//the texture was dropped before it became resident, the upload is thrown away
+		bool cancelled{ false };
+
+		std::string path;
+		VkSamplerCreateInfo samplerInfo{};
+		bool mipmaps{ true };
+		//levels dropped from the top of the chain, width and height are the size of the first uploaded level
+		uint32_t baseLevel{ 0 };
+		//reloads leave the finished image to the residency manager instead of registering a new texture
+		bool reload{ false };
+
+		//written by the worker that decodes the file
+		VkFormat format{ VK_FORMAT_UNDEFINED };
+		uint32_t width{ 0 }, height{ 0 };
+		uint32_t mipLevels{ 1 };
+		bool generateMips{ false };
+		std::vector<VkBufferImageCopy> regions;
+		AllocatedBuffer staging{};
+		VkDeviceSize stagingSize{ 0 };
+
+		VkCommandBuffer transferCommandBuffer{ VK_NULL_HANDLE };
+		VkCommandBuffer graphicsCommandBuffer{ VK_NULL_HANDLE };
+		VkSemaphore transferSemaphore{ VK_NULL_HANDLE };
+		VkFence uploadFence{ VK_NULL_HANDLE };
+
+		VkTexture texture{};
+		//registered with the asset manager once the upload finished
+		WeakRef<VkTexture> resident;
+		Ref<ResidentTexture> residency;
+	};
+
+	// uploads textures that were decoded on worker threads without blocking the frame. the copies run on the
+	// transfer queue, mip generation and the ownership transfer on the graphics queue
+	class TextureStreamer {
+	public:
+
+		void init(VulkanManager &manager, AssetManager &assets, ResidencyManager &residency, VkQueue graphicsQueue,
+			uint32_t graphicsFamily, VkQueue transferQueue, uint32_t transferFamily);
+		void cleanup();
+
+		//the file is decoded on the application thread pool
+		Ref<TextureRequest> request(const char *path, const VkSamplerCreateInfo &samplerInfo, bool mipmaps);
+		//uploads the chain of an already resident texture again, starting at baseLevel
+		Ref<TextureRequest> reload(const ResidentTexture &texture, uint32_t baseLevel);
+
+		//submits decoded textures within the per frame budget and finishes uploads the gpu is done with
+		void update();
+
+		//1x1 white texture that stands in for textures that are not resident yet
+		VkTexture &get_placeholder();
+		inline size_t get_pending_count() const { return m_Requests.size(); }
+
+	private:
+
+		//loads the file into a staging buffer, runs on a worker thread
+		static void decode(VulkanManager &manager, TextureRequest &request);
+		void schedule(Ref<TextureRequest> request);
+
+		void submit(TextureRequest &request);
+		void finish(TextureRequest &request);
+		void release_staging(TextureRequest &request);
+
+		VulkanManager *m_Manager{ nullptr };
+		AssetManager *m_Assets{ nullptr };
+		ResidencyManager *m_Residency{ nullptr };
+
+		VkQueue m_GraphicsQueue{ VK_NULL_HANDLE };
+		uint32_t m_GraphicsFamily{ 0 };
+		VkQueue m_TransferQueue{ VK_NULL_HANDLE };
+		uint32_t m_TransferFamily{ 0 };
+
+		VkCommandPool m_GraphicsPool{ VK_NULL_HANDLE };
+		VkCommandPool m_TransferPool{ VK_NULL_HANDLE };
+
+		VkTexture m_Placeholder{};
+
+		std::vector<Ref<TextureRequest>> m_Requests;
+	};
+
+}
@@ -0,0 +1,121 @@
+#include "vk_transient.h"
+
+namespace vkutil {
+
+	void TransientAllocator::init(VkDevice device, VmaAllocator allocator)
+	{
+		m_Device = device;
+		m_Allocator = allocator;
+	}
+
+	void TransientAllocator::cleanup()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (!m_Images.empty()) CORE_WARN("TransientAllocator: {} images were never destroyed", m_Images.size());
+
+		for (auto &[image, block] : m_Images) vkDestroyImage(m_Device, image, nullptr);
+		for (auto &block : m_Blocks) vmaFreeMemory(m_Allocator, block->allocation);
+
+		m_Images.clear();
+		m_Current.clear();
+		m_Blocks.clear();
+	}
+
+	void TransientAllocator::create_image(const VkImageCreateInfo &info, AllocatedImage *img)
+	{
+		CORE_ASSERT(m_Device, "TransientAllocator is not initialized");
+		CORE_ASSERT(info.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, "TransientAllocator: image is not a transient attachment");
+
+		VK_CHECK(vkCreateImage(m_Device, &info, nullptr, &img->image));
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(m_Device, img->image, &requirements);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		//the blocks are dedicated allocations, their offset 0 fits every alignment
+		Block *block = m_Current[info.format];
+		if (!block || block->size < requirements.size || !(requirements.memoryTypeBits & (1u << block->memoryType))) {
+			VkMemoryRequirements blockRequirements = requirements;
+			if (block) blockRequirements.size = std::max(requirements.size, block->size);
+
+			block = create_block(blockRequirements);
+			m_Current[info.format] = block;
+		}
+
+		VK_CHECK(vmaBindImageMemory(m_Allocator, block->allocation, img->image));
+
+		block->users++;
+		m_Images[img->image] = block;
+		img->allocation = block->allocation;
+	}
+
+	void TransientAllocator::destroy_image(AllocatedImage &img)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto it = m_Images.find(img.image);
+		if (it == m_Images.end()) {
+			CORE_WARN("TransientAllocator: image was not created by this allocator");
+			return;
+		}
+
+		Block *block = it->second;
+		m_Images.erase(it);
+		vkDestroyImage(m_Device, img.image, nullptr);
+		img = {};
+
+		if (--block->users > 0) return;
+
+		for (auto current = m_Current.begin(); current != m_Current.end(); current++) {
+			if (current->second != block) continue;
+			m_Current.erase(current);
+			break;
+		}
+
+		vmaFreeMemory(m_Allocator, block->allocation);
+		m_Blocks.erase(std::find_if(m_Blocks.begin(), m_Blocks.end(), [&](const Scope<Block> &b) { return b.get() == block; }));
+	}
+
+	TransientStats TransientAllocator::get_stats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		TransientStats stats{};
+		stats.blocks = (uint32_t)m_Blocks.size();
+		stats.images = (uint32_t)m_Images.size();
+
+		for (auto &block : m_Blocks) {
+			if (block->lazy) stats.lazyBlocks++;
+			stats.bytes += block->size;
+		}
+
+		return stats;
+	}
+
+	TransientAllocator::Block *TransientAllocator::create_block(const VkMemoryRequirements &requirements)
+	{
+		//lazily allocated memory only exists on some (mostly tiled) gpus, everywhere else this is plain device local memory
+		VmaAllocationCreateInfo allocInfo{};
+		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		allocInfo.preferredFlags = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+		Scope<Block> block = make_scope<Block>();
+
+		VmaAllocationInfo info{};
+		VK_CHECK(vmaAllocateMemory(m_Allocator, &requirements, &allocInfo, &block->allocation, &info));
+
+		VkMemoryPropertyFlags properties;
+		vmaGetMemoryTypeProperties(m_Allocator, info.memoryType, &properties);
+
+		block->size = requirements.size;
+		block->memoryType = info.memoryType;
+		block->lazy = properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+
+		m_Blocks.push_back(std::move(block));
+		return m_Blocks.back().get();
+	}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	struct TransientStats {
+		uint32_t blocks;
+		uint32_t lazyBlocks;
+		uint32_t images;
+		VkDeviceSize bytes;
+	};
+
+	//memory for attachments whose contents never outlive a render pass (cleared on load, not stored).
+	//all transient images of a format share one block of memory. render passes can not nest and begin_renderpass
+	//waits on the attachment writes of the pass before when it uses a transient image, so they never overlap.
+	//the blocks use lazily allocated memory where the device has it, tilers then never back them with real memory
+	class TransientAllocator {
+	public:
+
+		TransientAllocator() = default;
+
+		void init(VkDevice device, VmaAllocator allocator);
+		void cleanup();
+
+		//info.usage has to contain VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT. img->allocation is the shared block,
+		//it must only be freed through destroy_image
+		void create_image(const VkImageCreateInfo &info, AllocatedImage *img);
+		void destroy_image(AllocatedImage &img);
+
+		TransientStats get_stats();
+
+	private:
+
+		struct Block {
+			VmaAllocation allocation{ VK_NULL_HANDLE };
+			VkDeviceSize size{ 0 };
+			uint32_t memoryType{ 0 };
+			bool lazy{ false };
+			uint32_t users{ 0 };
+		};
+
+		Block *create_block(const VkMemoryRequirements &requirements);
+
+		VkDevice m_Device{ VK_NULL_HANDLE };
+		VmaAllocator m_Allocator{ VK_NULL_HANDLE };
+
+		std::mutex m_Mutex;
+		//blocks are only freed once their last image is destroyed, outgrown blocks stay until then
+		std::vector<Scope<Block>> m_Blocks;
+		//the block new images of a format are placed in
+		std::unordered_map<VkFormat, Block *> m_Current;
+		std::unordered_map<VkImage, Block *> m_Images;
+	};
+
+}
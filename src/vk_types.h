@@ -23,15 +23,24 @@ namespace vkutil {
 		VkImageView imageView{ VK_NULL_HANDLE };
 
 		uint32_t width, height;
+		uint32_t mipLevels{ 1 };
 		VkFormat format;
-
+		//layout the image is kept in while it is not rendered to, storage images stay in GENERAL
+		VkImageLayout layout{ VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		//part of the image render passes cover, 0 means all of it. pooled render targets are larger than they are used
+		VkExtent2D renderExtent{ 0, 0 };
+		//attachment only, its contents are not stored after a render pass. the memory is owned by the TransientAllocator
+		bool transient{ false };
+
+		//the texture can be shown through imgui, the descriptor is only created by imgui_descriptor once it is
 		bool bImguiDescriptor{ true };
-		VkDescriptorSet imguiDescriptor;
-		VkSampler sampler;
+		VkDescriptorSet imguiDescriptor{ VK_NULL_HANDLE };
+		VkSampler sampler{ VK_NULL_HANDLE }; //shared, owned by the SamplerCache
 	};
 
 	struct TextureCreateInfo {
 		uint32_t width, height;
+		uint32_t mipLevels{ 1 };
 		VkFormat format;
 		VkFilter filter;
 		VkImageUsageFlags usageFlags;
@@ -0,0 +1,192 @@
+#include "vk_upload_batch.h"
+
+#include "vk_manager.h"
+#include "vk_initializers.h"
+#include "ktx2.h"
+
+namespace vkutil {
+
+	static const VkDeviceSize c_InitialStagingSize = 4 * 1024 * 1024;
+	//buffer to image copies need offsets that are a multiple of the texel size and of 4
+	static const VkDeviceSize c_StagingAlignment = 16;
+
+	static const VkPipelineStageFlags c_TextureReadStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	void UploadBatch::init(VulkanManager &manager, VkQueue graphicsQueue, uint32_t graphicsFamily)
+	{
+		m_Manager = &manager;
+		m_GraphicsQueue = graphicsQueue;
+
+		VkCommandPoolCreateInfo poolInfo = vkinit::command_pool_create_info(graphicsFamily,
+			VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		VK_CHECK(vkCreateCommandPool(manager.device(), &poolInfo, nullptr, &m_CommandPool));
+
+		VkFenceCreateInfo fenceInfo = vkinit::fence_create_info();
+		VK_CHECK(vkCreateFence(manager.device(), &fenceInfo, nullptr, &m_Fence));
+	}
+
+	void UploadBatch::cleanup()
+	{
+		for (auto &buffer : m_Retired) destroy_buffer(*m_Manager, buffer);
+		m_Retired.clear();
+
+		if (m_Staging.buffer) {
+			vmaUnmapMemory(m_Manager->get_allocator(), m_Staging.allocation);
+			destroy_buffer(*m_Manager, m_Staging);
+		}
+
+		vkDestroyFence(m_Manager->device(), m_Fence, nullptr);
+		vkDestroyCommandPool(m_Manager->device(), m_CommandPool, nullptr);
+	}
+
+	void UploadBatch::update_texture(VkTexture &tex, const VkRect2D &region, const void *data, uint32_t rowPitch)
+	{
+		FormatBlockInfo block;
+		if (!format_block_info(tex.format, &block) || block.width > 1) {
+			CORE_WARN("UploadBatch: can not update textures of format {}", tex.format);
+			return;
+		}
+
+		if (region.offset.x < 0 || region.offset.y < 0
+			|| region.offset.x + region.extent.width > tex.width || region.offset.y + region.extent.height > tex.height) {
+			CORE_WARN("UploadBatch: region ({}, {}, {}, {}) is outside of the {}x{} texture", region.offset.x, region.offset.y,
+				region.extent.width, region.extent.height, tex.width, tex.height);
+			return;
+		}
+
+		if (region.extent.width == 0 || region.extent.height == 0) return;
+
+		uint32_t packedPitch = region.extent.width * block.bytes;
+		if (rowPitch == 0) rowPitch = packedPitch;
+
+		if (rowPitch < packedPitch) {
+			CORE_WARN("UploadBatch: row pitch {} is smaller than a row of the region ({})", rowPitch, packedPitch);
+			return;
+		}
+
+		VkDeviceSize size = (VkDeviceSize)packedPitch * region.extent.height;
+		VkDeviceSize offset = allocate(size);
+
+		//rows are packed while copying, the copy doesn't have to know the pitch of the source
+		const uint8_t *src = (const uint8_t *)data;
+		if (rowPitch == packedPitch) memcpy(m_Mapped + offset, src, size);
+		else {
+			for (uint32_t y = 0; y < region.extent.height; y++) {
+				memcpy(m_Mapped + offset + (VkDeviceSize)y * packedPitch, src + (size_t)y * rowPitch, packedPitch);
+			}
+		}
+
+		begin();
+		VkCommandBuffer cmd = m_CommandBuffers[m_UsedCommandBuffers];
+
+		VkImageSubresourceRange range{};
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.levelCount = 1;
+		range.layerCount = 1;
+
+		//the old layout keeps the texels outside of the region, earlier updates of the batch are finished first
+		insert_image_memory_barrier(cmd, tex.imageAllocation.image,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			tex.layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			c_TextureReadStages | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			range);
+
+		VkBufferImageCopy copy{};
+		copy.bufferOffset = offset;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = { region.offset.x, region.offset.y, 0 };
+		copy.imageExtent = { region.extent.width, region.extent.height, 1 };
+
+		vkCmdCopyBufferToImage(cmd, m_Staging.buffer, tex.imageAllocation.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+		if (tex.mipLevels > 1) {
+			generate_mipmaps(cmd, tex.imageAllocation.image, tex.width, tex.height, tex.mipLevels, tex.layout, tex.layout, &region);
+			return;
+		}
+
+		insert_image_memory_barrier(cmd, tex.imageAllocation.image,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, tex.layout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, c_TextureReadStages,
+			range);
+	}
+
+	VkCommandBuffer UploadBatch::end()
+	{
+		if (!m_Recording) return VK_NULL_HANDLE;
+
+		VkCommandBuffer cmd = m_CommandBuffers[m_UsedCommandBuffers++];
+		VK_CHECK(vkEndCommandBuffer(cmd));
+		m_Recording = false;
+
+		return cmd;
+	}
+
+	void UploadBatch::reset()
+	{
+		if (m_Recording) return;
+
+		for (auto &buffer : m_Retired) destroy_buffer(*m_Manager, buffer);
+		m_Retired.clear();
+
+		m_UsedCommandBuffers = 0;
+		m_Offset = 0;
+	}
+
+	void UploadBatch::flush()
+	{
+		VkCommandBuffer cmd = end();
+		if (!cmd) return;
+
+		VkSubmitInfo submit = vkinit::submit_info(&cmd);
+		VK_CHECK(vkQueueSubmit(m_GraphicsQueue, 1, &submit, m_Fence));
+
+		VK_CHECK(vkWaitForFences(m_Manager->device(), 1, &m_Fence, true, UINT64_MAX));
+		VK_CHECK(vkResetFences(m_Manager->device(), 1, &m_Fence));
+
+		reset();
+	}
+
+	void UploadBatch::begin()
+	{
+		if (m_Recording) return;
+
+		if (m_UsedCommandBuffers == m_CommandBuffers.size()) {
+			VkCommandBuffer cmd;
+			VkCommandBufferAllocateInfo allocInfo = vkinit::command_buffer_allocate_info(m_CommandPool);
+			VK_CHECK(vkAllocateCommandBuffers(m_Manager->device(), &allocInfo, &cmd));
+			m_CommandBuffers.push_back(cmd);
+		}
+
+		VkCommandBufferBeginInfo beginInfo = vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		VK_CHECK(vkBeginCommandBuffer(m_CommandBuffers[m_UsedCommandBuffers], &beginInfo));
+
+		m_Recording = true;
+	}
+
+	VkDeviceSize UploadBatch::allocate(VkDeviceSize size)
+	{
+		VkDeviceSize offset = (m_Offset + c_StagingAlignment - 1) / c_StagingAlignment * c_StagingAlignment;
+
+		if (offset + size > m_Capacity) {
+			if (m_Staging.buffer) {
+				vmaUnmapMemory(m_Manager->get_allocator(), m_Staging.allocation);
+				m_Retired.push_back(m_Staging);
+			}
+
+			m_Capacity = std::max({ c_InitialStagingSize, m_Capacity * 2, size });
+			create_buffer(*m_Manager, m_Capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_Staging);
+
+			void *mapped;
+			VK_CHECK(vmaMapMemory(m_Manager->get_allocator(), m_Staging.allocation, &mapped));
+			m_Mapped = (uint8_t *)mapped;
+
+			offset = 0;
+		}
+
+		m_Offset = offset + size;
+		return offset;
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "vk_types.h"
+
+namespace vkutil {
+
+	class VulkanManager;
+
+	// texture updates of a frame. the data is copied into a staging buffer right away and the copies are recorded
+	// into command buffers that are submitted in front of the frame's graphics work, nothing waits on the gpu
+	class UploadBatch {
+	public:
+
+		void init(VulkanManager &manager, VkQueue graphicsQueue, uint32_t graphicsFamily);
+		void cleanup();
+
+		//region is in texels of level 0, rowPitch in bytes with 0 meaning tightly packed rows.
+		//the texels outside of region are kept. the other levels only blit the texels that depend on region again,
+		//levels with an odd side are blitted whole
+		void update_texture(VkTexture &tex, const VkRect2D &region, const void *data, uint32_t rowPitch = 0);
+
+		//ends the recorded updates, the returned command buffer has to be submitted before the work that reads the
+		//textures. VK_NULL_HANDLE if nothing was recorded
+		VkCommandBuffer end();
+		//the submissions of the last frame finished, staging memory and command buffers are reused
+		void reset();
+		//submits updates recorded outside of a frame and waits for them
+		void flush();
+
+	private:
+
+		void begin();
+		//returns the offset into the staging buffer, the buffer grows if it is full
+		VkDeviceSize allocate(VkDeviceSize size);
+
+		VulkanManager *m_Manager{ nullptr };
+		VkQueue m_GraphicsQueue{ VK_NULL_HANDLE };
+
+		VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+		//one per end() within a frame, the frame can be submitted in parts
+		std::vector<VkCommandBuffer> m_CommandBuffers;
+		uint32_t m_UsedCommandBuffers{ 0 };
+		VkFence m_Fence{ VK_NULL_HANDLE };
+
+		AllocatedBuffer m_Staging{};
+		uint8_t *m_Mapped{ nullptr };
+		VkDeviceSize m_Capacity{ 0 };
+		VkDeviceSize m_Offset{ 0 };
+		//outgrown staging buffers, copies of this frame may still read them
+		std::vector<AllocatedBuffer> m_Retired;
+
+		bool m_Recording{ false };
+	};
+
+}
@@ -0,0 +1,147 @@
+#include "bc_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace bc {
+
+	static uint16_t pack_565(const int color[3])
+	{
+		int r = (color[0] * 31 + 127) / 255;
+		int g = (color[1] * 63 + 127) / 255;
+		int b = (color[2] * 31 + 127) / 255;
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void unpack_565(uint16_t packed, int color[3])
+	{
+		int r = (packed >> 11) & 31;
+		int g = (packed >> 5) & 63;
+		int b = packed & 31;
+
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	static void encode_color_block(const uint8_t texels[64], uint8_t out[8])
+	{
+		int minColor[3] = { 255, 255, 255 };
+		int maxColor[3] = { 0, 0, 0 };
+
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 3; c++) {
+				minColor[c] = std::min(minColor[c], (int)texels[i * 4 + c]);
+				maxColor[c] = std::max(maxColor[c], (int)texels[i * 4 + c]);
+			}
+		}
+
+		//pull the endpoints in a bit, the palette then covers the block more evenly
+		for (int c = 0; c < 3; c++) {
+			int inset = (maxColor[c] - minColor[c]) / 16;
+			minColor[c] = std::min(255, minColor[c] + inset);
+			maxColor[c] = std::max(0, maxColor[c] - inset);
+		}
+
+		uint16_t c0 = pack_565(maxColor);
+		uint16_t c1 = pack_565(minColor);
+
+		uint32_t indices = 0;
+
+		//equal endpoints leave every index at 0
+		if (c0 != c1) {
+			//c0 > c1 selects the four color mode
+			if (c0 < c1) std::swap(c0, c1);
+
+			int palette[4][3];
+			unpack_565(c0, palette[0]);
+			unpack_565(c1, palette[1]);
+
+			for (int c = 0; c < 3; c++) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+
+			for (int i = 0; i < 16; i++) {
+				int best = 0;
+				int bestDistance = INT32_MAX;
+
+				for (int p = 0; p < 4; p++) {
+					int distance = 0;
+					for (int c = 0; c < 3; c++) {
+						int d = (int)texels[i * 4 + c] - palette[p][c];
+						distance += d * d;
+					}
+
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						best = p;
+					}
+				}
+
+				indices |= (uint32_t)best << (i * 2);
+			}
+		}
+
+		out[0] = (uint8_t)(c0 & 0xff);
+		out[1] = (uint8_t)(c0 >> 8);
+		out[2] = (uint8_t)(c1 & 0xff);
+		out[3] = (uint8_t)(c1 >> 8);
+		std::memcpy(out + 4, &indices, sizeof(indices));
+	}
+
+	static void encode_alpha_block(const uint8_t texels[64], uint8_t out[8])
+	{
+		int a0 = 0;
+		int a1 = 255;
+
+		for (int i = 0; i < 16; i++) {
+			a0 = std::max(a0, (int)texels[i * 4 + 3]);
+			a1 = std::min(a1, (int)texels[i * 4 + 3]);
+		}
+
+		uint64_t indices = 0;
+
+		//a0 > a1 selects the eight value mode, equal endpoints leave every index at 0
+		if (a0 != a1) {
+			int palette[8];
+			palette[0] = a0;
+			palette[1] = a1;
+			for (int p = 1; p < 7; p++) palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+			for (int i = 0; i < 16; i++) {
+				int alpha = texels[i * 4 + 3];
+
+				int best = 0;
+				int bestDistance = INT32_MAX;
+
+				for (int p = 0; p < 8; p++) {
+					int distance = std::abs(alpha - palette[p]);
+					if (distance < bestDistance) {
+						bestDistance = distance;
+						best = p;
+					}
+				}
+
+				indices |= (uint64_t)best << (i * 3);
+			}
+		}
+
+		out[0] = (uint8_t)a0;
+		out[1] = (uint8_t)a1;
+		for (int i = 0; i < 6; i++) out[2 + i] = (uint8_t)(indices >> (i * 8));
+	}
+
+	void encode_bc1(const uint8_t texels[64], uint8_t out[8])
+	{
+		encode_color_block(texels, out);
+	}
+
+	void encode_bc3(const uint8_t texels[64], uint8_t out[16])
+	{
+		encode_alpha_block(texels, out);
+		encode_color_block(texels, out + 8);
+	}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// small block compression encoder used by ktx_convert. endpoints come from the inset bounding box
+// of the block, which is fast and good enough for offline texture conversion
+namespace bc {
+
+	//texels is a 4x4 block of rgba8 texels in row major order
+	void encode_bc1(const uint8_t texels[64], uint8_t out[8]);
+	void encode_bc3(const uint8_t texels[64], uint8_t out[16]);
+
+}
@@ -0,0 +1,157 @@
+#include "bc_encoder.h"
+#include "ktx2.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// converts an image into a block compressed KTX2 texture with a full mip chain
+//   ktx_convert <input> <output.ktx2> [--bc1 | --bc3] [--srgb] [--no-mips]
+// without a format flag images with transparent texels are written as BC3, everything else as BC1
+
+struct Image {
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	std::vector<uint8_t> texels; //rgba8
+};
+
+static Image downsample(const Image &src)
+{
+	Image dst;
+	dst.width = std::max(1u, src.width / 2);
+	dst.height = std::max(1u, src.height / 2);
+	dst.texels.resize((size_t)dst.width * dst.height * 4);
+
+	//2x2 box filter, odd edges reuse the last row / column
+	for (uint32_t y = 0; y < dst.height; y++) {
+		for (uint32_t x = 0; x < dst.width; x++) {
+			uint32_t x0 = std::min(x * 2, src.width - 1);
+			uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+			uint32_t y0 = std::min(y * 2, src.height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+
+			for (uint32_t c = 0; c < 4; c++) {
+				uint32_t sum = src.texels[((size_t)y0 * src.width + x0) * 4 + c]
+					+ src.texels[((size_t)y0 * src.width + x1) * 4 + c]
+					+ src.texels[((size_t)y1 * src.width + x0) * 4 + c]
+					+ src.texels[((size_t)y1 * src.width + x1) * 4 + c];
+
+				dst.texels[((size_t)y * dst.width + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+			}
+		}
+	}
+
+	return dst;
+}
+
+static void compress(const Image &image, bool bc3, std::vector<uint8_t> *out)
+{
+	uint32_t blocksX = (image.width + 3) / 4;
+	uint32_t blocksY = (image.height + 3) / 4;
+	size_t blockBytes = bc3 ? 16 : 8;
+
+	size_t offset = out->size();
+	out->resize(offset + (size_t)blocksX * blocksY * blockBytes);
+
+	uint8_t block[64];
+
+	for (uint32_t by = 0; by < blocksY; by++) {
+		for (uint32_t bx = 0; bx < blocksX; bx++) {
+			//blocks hanging over the edge repeat the border texels
+			for (uint32_t y = 0; y < 4; y++) {
+				for (uint32_t x = 0; x < 4; x++) {
+					uint32_t sx = std::min(bx * 4 + x, image.width - 1);
+					uint32_t sy = std::min(by * 4 + y, image.height - 1);
+					std::memcpy(block + (y * 4 + x) * 4, image.texels.data() + ((size_t)sy * image.width + sx) * 4, 4);
+				}
+			}
+
+			uint8_t *dst = out->data() + offset + ((size_t)by * blocksX + bx) * blockBytes;
+			if (bc3) bc::encode_bc3(block, dst);
+			else bc::encode_bc1(block, dst);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s <input> <output.ktx2> [--bc1 | --bc3] [--srgb] [--no-mips]\n", argv[0]);
+		return 1;
+	}
+
+	const char *input = argv[1];
+	const char *output = argv[2];
+
+	enum class Format { Auto, BC1, BC3 } format = Format::Auto;
+	bool srgb = false;
+	bool mips = true;
+
+	for (int i = 3; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--bc1") format = Format::BC1;
+		else if (arg == "--bc3") format = Format::BC3;
+		else if (arg == "--srgb") srgb = true;
+		else if (arg == "--no-mips") mips = false;
+		else {
+			std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	int w, h, nC;
+	stbi_uc *pixels = stbi_load(input, &w, &h, &nC, STBI_rgb_alpha);
+	if (!pixels) {
+		std::fprintf(stderr, "failed to load %s: %s\n", input, stbi_failure_reason());
+		return 1;
+	}
+
+	Image image;
+	image.width = (uint32_t)w;
+	image.height = (uint32_t)h;
+	image.texels.assign(pixels, pixels + (size_t)w * h * 4);
+	stbi_image_free(pixels);
+
+	if (format == Format::Auto) {
+		bool opaque = true;
+		for (size_t i = 3; i < image.texels.size() && opaque; i += 4) opaque = image.texels[i] == 255;
+
+		format = opaque ? Format::BC1 : Format::BC3;
+	}
+
+	bool bc3 = format == Format::BC3;
+
+	vkutil::Ktx2Image ktx;
+	ktx.width = image.width;
+	ktx.height = image.height;
+	if (bc3) ktx.format = srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+	else ktx.format = srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+
+	while (true) {
+		vkutil::Ktx2Level level;
+		level.offset = ktx.data.size();
+		compress(image, bc3, &ktx.data);
+		level.size = ktx.data.size() - level.offset;
+		ktx.levels.push_back(level);
+
+		if (!mips || (image.width == 1 && image.height == 1)) break;
+		image = downsample(image);
+	}
+
+	std::string error;
+	if (!vkutil::write_ktx2(output, ktx, &error)) {
+		std::fprintf(stderr, "failed to write %s: %s\n", output, error.c_str());
+		return 1;
+	}
+
+	std::printf("%s -> %s (%s, %ux%u, %zu levels)\n", input, output, bc3 ? "BC3" : "BC1",
+		ktx.width, ktx.height, ktx.levels.size());
+
+	return 0;
+}